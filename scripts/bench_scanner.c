@@ -0,0 +1,97 @@
+/* Scanner throughput benchmark.
+ *
+ * Builds a large corpus by repeating the given source files and reports how
+ * many tokens per second scanToken() produces over it.
+ *
+ *   make bench
+ *   ./bin/bench_scanner tests/*.ss
+ */
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../src/scanner.h"
+
+#define CORPUS_SIZE (64 * 1024 * 1024)
+#define ROUNDS      5
+
+static char* readSource(const char* path, size_t* length) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        fprintf(stderr, "Could not open file \"%s\".\n", path);
+        exit(74);
+    }
+    fseek(file, 0L, SEEK_END);
+    *length = ftell(file);
+    rewind(file);
+
+    char* buffer = (char*)malloc(*length + 1);
+    if (buffer == NULL || fread(buffer, 1, *length, file) < *length) {
+        fprintf(stderr, "Could not read file \"%s\".\n", path);
+        exit(74);
+    }
+    buffer[*length] = '\0';
+    fclose(file);
+    return buffer;
+}
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: ./bench_scanner file.ss [file.ss ...]\n");
+        return 64;
+    }
+
+    char* corpus = (char*)malloc(CORPUS_SIZE + 1);
+    size_t used = 0;
+    bool full = false;
+    while (!full) {
+        for (int i = 1; i < argc && !full; i++) {
+            size_t length;
+            char* source = readSource(argv[i], &length);
+            if (used + length + 1 > CORPUS_SIZE) {
+                full = true;
+            } else {
+                memcpy(corpus + used, source, length);
+                used += length;
+                corpus[used++] = '\n';
+            }
+            free(source);
+        }
+        if (used == 0) break;
+    }
+    corpus[used] = '\0';
+
+    double best = 0.0;
+    long tokens = 0;
+    for (int round = 0; round < ROUNDS; round++) {
+        Scanner scanner;
+        initScanner(&scanner, corpus);
+        long count = 0;
+        double start = now();
+        for (;;) {
+            Token token = scanToken(&scanner);
+            count++;
+            if (token.type == TOKEN_EOF) break;
+        }
+        double elapsed = now() - start;
+        if (best == 0.0 || elapsed < best) best = elapsed;
+        tokens = count;
+    }
+
+    printf("corpus     : %.1f MiB\n", used / (1024.0 * 1024.0));
+    printf("tokens     : %ld\n", tokens);
+    printf("best time  : %.3f s (of %d rounds)\n", best, ROUNDS);
+    printf("throughput : %.1f Mtokens/s, %.1f MiB/s\n",
+           tokens / best / 1e6, used / best / (1024.0 * 1024.0));
+
+    free(corpus);
+    return 0;
+}
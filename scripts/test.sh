@@ -6,8 +6,8 @@ VERSION=$(cat ${VERSIONFILE} | grep -oP "#define.*?VERSION.*?\"\K[0-9]\.[0-9]\.[
 TESTS="./tests/*.ss"
 TEMP="stderr.temp"
 
-COUNT=$(ls ${TESTS} | wc -l)
-((COUNT--))
+# benchmarks are not counted as tests
+COUNT=$(ls ${TESTS} | grep -v "_benchmark" | wc -l)
 PASSED=0
 N=1
 
@@ -68,6 +68,20 @@ for TEST in ${TESTS}; do
         continue
     fi
 
+    # Tests that have to stop with a runtime error name it in an
+    # "// expect: " comment, which has to show up on stderr
+    EXPECT=$(grep -Po "^// expect: \K.*" ${TEST})
+    if [[ -n ${EXPECT} ]]; then
+        if grep -qF "${EXPECT}" ${TEMP} && ! grep -q "FAIL" <<< "$OUTPUT"; then
+            _pass
+            ((PASSED++))
+        else
+            _fail
+        fi
+        ((N++))
+        continue
+    fi
+
     # Parsing outputs for errors
     RESULT=$(grep -E "FAIL" <<< "$OUTPUT") # stdout
     RESULT+=$(cat ${TEMP} | grep -E "ERROR|Undefined|Error|Expect|dumped") # stderr
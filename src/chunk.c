@@ -16,6 +16,10 @@ void initChunk(VM* vm __attribute__((unused)), Chunk* chunk) {
     /* initialized as an address since the chunk struct does not 
     have it as a pointer */
     initValueArray(&chunk->constants);
+
+    chunk->caches = NULL;
+    chunk->cacheCount = 0;
+    chunk->cacheCapacity = 0;
 }
 
 void writeChunk(VM* vm, Chunk* chunk, uint8_t byte, int line) {
@@ -39,6 +43,20 @@ void writeChunk(VM* vm, Chunk* chunk, uint8_t byte, int line) {
     chunk->count++;
 }
 
+int addInvokeCache(VM* vm, Chunk* chunk) {
+    if (chunk->cacheCapacity < chunk->cacheCount+1) {
+        int oldCapacity = chunk->cacheCapacity;
+        chunk->cacheCapacity = GROW_CAPACITY(oldCapacity);
+        chunk->caches = GROW_ARRAY(vm, InvokeCache,
+                chunk->caches,
+                oldCapacity,
+                chunk->cacheCapacity);
+    }
+    chunk->caches[chunk->cacheCount].klass = NULL;
+    chunk->caches[chunk->cacheCount].method = NULL;
+    return chunk->cacheCount++;
+}
+
 int addConstant(VM* vm, Chunk *chunk, Value value) {
     push(vm, value);
     writeValueArray(vm, &chunk->constants, value);
@@ -48,9 +66,90 @@ int addConstant(VM* vm, Chunk *chunk, Value value) {
     return chunk->constants.count - 1;
 }
 
+int instructionLength(Chunk* chunk, int offset) {
+    switch (chunk->code[offset]) {
+        case OP_CONSTANT:
+        case OP_GET_LOCAL:
+        case OP_SET_LOCAL:
+        case OP_SET_LOCAL_POP:
+        case OP_GET_GLOBAL:
+        case OP_DEFINE_GLOBAL:
+        case OP_SET_GLOBAL:
+        case OP_GET_MODULE:
+        case OP_DEFINE_MODULE:
+        case OP_SET_MODULE:
+        case OP_MAKE_LIST:
+        case OP_MAKE_MAP:
+        case OP_GET_UPVALUE:
+        case OP_SET_UPVALUE:
+        case OP_GET_PROPERTY:
+        case OP_GET_PROPERTY_NOPOP:
+        case OP_SET_PROPERTY:
+        case OP_GET_SUPER:
+        case OP_MODULE:
+        case OP_CALL:
+        case OP_TAIL_CALL:
+        case OP_CALL_NATIVE:
+        case OP_CLASS:
+        case OP_METHOD:
+        case OP_INCREMENT_LOCAL:
+        case OP_DECREMENT_LOCAL:
+            return 2;
+
+        case OP_MODULE_BUILTIN:
+        case OP_JUMP:
+        case OP_JUMP_IF_FALSE:
+        case OP_LOOP:
+        case OP_ADD_LL:
+        case OP_SUBTRACT_LL:
+        case OP_MULTIPLY_LL:
+        case OP_DIVIDE_LL:
+        case OP_LESS_LL:
+        case OP_GREATER_LL:
+        case OP_ADD_LC:
+        case OP_SUBTRACT_LC:
+        case OP_MULTIPLY_LC:
+        case OP_DIVIDE_LC:
+        case OP_LESS_LC:
+        case OP_GREATER_LC:
+            return 3;
+
+        case OP_ITER_NEXT:
+        case OP_ADD_LL_SET:
+        case OP_SUBTRACT_LL_SET:
+        case OP_MULTIPLY_LL_SET:
+        case OP_DIVIDE_LL_SET:
+        case OP_ADD_LC_SET:
+        case OP_SUBTRACT_LC_SET:
+        case OP_MULTIPLY_LC_SET:
+        case OP_DIVIDE_LC_SET:
+            return 4;
+
+        case OP_JUMP_IF_NOT_LESS_LL:
+        case OP_JUMP_IF_NOT_GREATER_LL:
+        case OP_JUMP_IF_NOT_LESS_LC:
+        case OP_JUMP_IF_NOT_GREATER_LC:
+        case OP_INVOKE:
+        case OP_SUPER_INVOKE:
+        case OP_TAIL_INVOKE:
+            return 5;
+
+        case OP_CLOSURE: {
+            // one byte for the constant, then two for each upvalue
+            ObjFunction* function =
+                AS_FUNCTION(chunk->constants.values[chunk->code[offset+1]]);
+            return 2 + function->upvalueCount*2;
+        }
+
+        default:
+            return 1;
+    }
+}
+
 void freeChunk(VM* vm, Chunk* chunk) {
     FREE_ARRAY(vm, uint8_t, chunk->code, chunk->capacity);
     FREE_ARRAY(vm, int, chunk->lines, chunk->capacity);
     freeValueArray(vm, &chunk->constants);
+    FREE_ARRAY(vm, InvokeCache, chunk->caches, chunk->cacheCapacity);
     initChunk(vm, chunk); // zero out the fields, so it's in an empty state
 }
@@ -18,6 +18,7 @@ typedef enum {
     OP_POP,
     OP_GET_LOCAL,
     OP_SET_LOCAL,
+    OP_SET_LOCAL_POP,
 
     OP_GET_GLOBAL,
     OP_DEFINE_GLOBAL,
@@ -28,9 +29,11 @@ typedef enum {
     OP_SET_MODULE,
 
     OP_MAKE_LIST,
+    OP_MAKE_MAP,
     OP_SUBSCRIPT_ASSIGN,
     OP_SUBSCRIPT_IDX,
     OP_SUBSCRIPT_IDX_NOPOP,
+    OP_SLICE,
 
     OP_GET_UPVALUE,
     OP_SET_UPVALUE,
@@ -39,8 +42,11 @@ typedef enum {
     OP_SET_PROPERTY,
     OP_GET_SUPER,
     OP_EQUAL,
+    OP_NOT_EQUAL,
     OP_GREATER,
+    OP_GREATER_EQUAL,
     OP_LESS,
+    OP_LESS_EQUAL,
 
     OP_ADD,
     OP_SUBTRACT,
@@ -60,12 +66,13 @@ typedef enum {
 
     OP_NEGATE,
     OP_PRINT,
-    OP_BREAK,
     OP_JUMP,
     OP_JUMP_IF_FALSE,
     OP_LOOP,
+    OP_ITER_INIT,
+    OP_ITER_NEXT,    // slot of the iterable, 16-bit jump past the loop
     OP_CALL,
-    OP_INVOKE,
+    OP_INVOKE,       // name, argument count, 16-bit invoke cache slot
     OP_SUPER_INVOKE,
     OP_CLOSURE,
     OP_CLOSE_UPVALUE,
@@ -73,9 +80,70 @@ typedef enum {
     OP_CLASS,
     OP_INHERIT,
     OP_END_CLASS,
-    OP_METHOD
+    OP_METHOD,
+
+    /* Register-style ops over frame slots, built by the optimizer.
+     * _LL  : push  slot[a] op slot[b]
+     * _LC  : push  slot[a] op constant[k]
+     * _SET : slot[d] = slot[a] op slot[b] / constant[k]
+     * Each group keeps the order add, subtract, multiply, divide, less,
+     * greater.
+     */
+    OP_ADD_LL,
+    OP_SUBTRACT_LL,
+    OP_MULTIPLY_LL,
+    OP_DIVIDE_LL,
+    OP_LESS_LL,
+    OP_GREATER_LL,
+    OP_ADD_LC,
+    OP_SUBTRACT_LC,
+    OP_MULTIPLY_LC,
+    OP_DIVIDE_LC,
+    OP_LESS_LC,
+    OP_GREATER_LC,
+    OP_ADD_LL_SET,
+    OP_SUBTRACT_LL_SET,
+    OP_MULTIPLY_LL_SET,
+    OP_DIVIDE_LL_SET,
+    OP_ADD_LC_SET,
+    OP_SUBTRACT_LC_SET,
+    OP_MULTIPLY_LC_SET,
+    OP_DIVIDE_LC_SET,
+    OP_INCREMENT_LOCAL,
+    OP_DECREMENT_LOCAL,
+
+    /* Compare-and-branch over frame slots, built by the optimizer. Jumps
+     * forward when slot[a] op slot[b] / constant[k] does not hold, without
+     * pushing the condition. Kept in the order of the _LL and _LC compares.
+     */
+    OP_JUMP_IF_NOT_LESS_LL,
+    OP_JUMP_IF_NOT_GREATER_LL,
+    OP_JUMP_IF_NOT_LESS_LC,
+    OP_JUMP_IF_NOT_GREATER_LC,
+
+    /* Calls in tail position, built by the optimizer from a call followed
+     * by OP_RETURN. The current frame is reused when the callee is a
+     * closure, otherwise they act as the plain call.
+     */
+    OP_TAIL_CALL,
+    OP_TAIL_INVOKE,
+
+    /* Written over OP_CALL by the VM once a call site has called a native,
+     * skipping the dispatch on the callee type. Other callees still work.
+     */
+    OP_CALL_NATIVE
 } OpCode;
 
+/**
+ * @brief Cache of the method last invoked from one call site, keyed on the
+ * class of the receiver. Both objects are kept alive by the chunk.
+ *
+ */
+typedef struct {
+    Obj* klass;
+    Obj* method;
+} InvokeCache;
+
 /**
  * @brief Defining a chunk as a pointer to uint8
  *
@@ -86,6 +154,11 @@ typedef struct {
     uint8_t* code;
     int* lines;
     ValueArray constants;
+
+    // one slot per invoke instruction, indexed by its last operand
+    InvokeCache* caches;
+    int cacheCount;
+    int cacheCapacity;
 } Chunk; 
 
 /**
@@ -113,6 +186,24 @@ void writeChunk( VM* vm, Chunk* chunk, uint8_t byte, int line );
  */
 int addConstant( VM* vm, Chunk* chunk, Value value );
 
+/**
+ * @brief Method to add an empty invoke cache slot to the chunk
+ * @param chunk The chunk to add the slot to
+ * @return int The index of the new slot
+ *
+ */
+int addInvokeCache( VM* vm, Chunk* chunk );
+
+/**
+ * @brief Method to get the size of the instruction at the given offset,
+ * opcode and operands included
+ * @param chunk The chunk holding the instruction
+ * @param offset Offset of the opcode
+ * @return int Size of the instruction in bytes
+ *
+ */
+int instructionLength( Chunk* chunk, int offset );
+
 /**
  * @brief Method to free the chunk pointer
  * @param chunk The chunk to free
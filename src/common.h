@@ -7,8 +7,14 @@
 
 #define NAN_BOXING
 
+// dispatch through a table of label addresses where the compiler allows it
+#if defined(__GNUC__) && !defined(NO_THREADED_DISPATCH)
+#define THREADED_DISPATCH
+#endif
+
 // #define DEBUG_PRINT_CODE
 // #define DEBUG_TRACE_EXECUTION
+// #define DEBUG_COUNT_INSTRUCTIONS
 
 // #define DEBUG_STRESS_GC
 // #define DEBUG_LOG_GC
@@ -1,3 +1,4 @@
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -7,9 +8,11 @@
 #include "compiler.h"
 #include "memory.h"
 #include "object.h"
+#include "optimizer.h"
 #include "scanner.h"
 #include "table.h"
 #include "value.h"
+#include "vm.h"
 #include "library.h"
 
 #ifdef DEBUG_PRINT_CODE
@@ -156,6 +159,24 @@ static void emitBytes(Compiler* compiler, uint8_t byte1, uint8_t byte2) {
     emitByte(compiler, byte2);
 }
 
+/**
+ * @brief Method to emit a method invocation with its own invoke cache slot
+ * @param instruction The invoke opcode
+ * @param name Constant index of the method name
+ * @param argCount Number of arguments passed
+ *
+ */
+static void emitInvoke(Compiler* compiler, uint8_t instruction, uint8_t name,
+                       uint8_t argCount) {
+    int cache = addInvokeCache(compiler->parser->vm, currentChunk(compiler));
+    if (cache > UINT16_MAX) {
+        error(compiler->parser, "Too many method calls in one function.");
+    }
+    emitBytes(compiler, instruction, name);
+    emitByte(compiler, argCount);
+    emitBytes(compiler, (cache >> 8) & 0xff, cache & 0xff);
+}
+
 static void emitLoop(Compiler* compiler, int loopStart) {
     emitByte(compiler, OP_LOOP);
 
@@ -227,6 +248,8 @@ static void patchJump(Compiler* compiler, int offset) {
     }
     currentChunk(compiler)->code[offset] = (jump >> 8) & 0xff;
     currentChunk(compiler)->code[offset+1] = jump & 0xff;
+    // code jumping to the current end can no longer be rewritten
+    compiler->lastProperty = -1;
 }
 
 /**
@@ -247,6 +270,10 @@ static void initCompiler(Parser* parser, Compiler* compiler, Compiler* parent, F
     compiler->type = type;
     compiler->localCount = 0;
     compiler->scopeDepth = 0;
+    compiler->operandStart = 0;
+    compiler->constantFloor = 0;
+    compiler->lastProperty = -1;
+    parser->vm->compiler = compiler;
     compiler->function = newFunction(parser->vm, parser->module, type);
 
     // storing the function's name (if not top-level/script)
@@ -263,6 +290,7 @@ static void initCompiler(Parser* parser, Compiler* compiler, Compiler* parent, F
     local->isConst = false;
     local->isScoped = false;
     local->isCaptured = false;
+    local->hasValue = false;
     if (type != TYPE_FUNCTION) {
         local->name.start = "this";
         local->name.length = 4;
@@ -272,6 +300,38 @@ static void initCompiler(Parser* parser, Compiler* compiler, Compiler* parent, F
     }
 }
 
+/**
+ * @brief Method to mark methods that only read or write one field of
+ * `this`, going by their optimized code
+ *
+ * @param function The method to check
+ */
+static void findAccessor(ObjFunction* function) {
+    Chunk* chunk = &function->chunk;
+    uint8_t* code = chunk->code;
+    if (code[0] != OP_GET_LOCAL || code[1] != 0) return;
+
+    if (function->params == 0 && chunk->count == 5 &&
+        code[2] == OP_GET_PROPERTY && code[4] == OP_RETURN) {
+        function->accessor = ACCESSOR_GET;
+        function->field = AS_STRING(chunk->constants.values[code[3]]);
+        return;
+    }
+    if (function->params != 1 || chunk->count < 9 ||
+        code[2] != OP_GET_LOCAL || code[3] != 1 ||
+        code[4] != OP_SET_PROPERTY || code[6] != OP_POP) return;
+
+    if (chunk->count == 9 && code[7] == OP_NULL && code[8] == OP_RETURN) {
+        function->accessor = ACCESSOR_SET;
+    } else if (chunk->count == 10 && code[7] == OP_GET_LOCAL &&
+               code[8] == 0 && code[9] == OP_RETURN) {
+        function->accessor = ACCESSOR_SET_THIS;
+    } else {
+        return;
+    }
+    function->field = AS_STRING(chunk->constants.values[code[5]]);
+}
+
 /**
  * @brief Method to end the compiler by returning the function object
  *
@@ -279,6 +339,12 @@ static void initCompiler(Parser* parser, Compiler* compiler, Compiler* parent, F
 static ObjFunction* endCompiler(Compiler* compiler) {
     emitReturn(compiler);
     ObjFunction* function = compiler->function;
+    if (!compiler->parser->hadError) {
+        optimizeChunk(compiler->parser->vm, &function->chunk);
+        function->stackSize = stackSize(compiler->parser->vm,
+                                        &function->chunk, function->params+1);
+        if (compiler->type == TYPE_METHOD) findAccessor(function);
+    }
 #ifdef DEBUG_PRINT_CODE
     if (!compiler->parser->hadError) {
         // pointing out where the error occurred. "<script>" if at
@@ -341,6 +407,55 @@ static void parsePrecedence(Compiler* compiler, Precedence precedence);
 
 static uint8_t argumentList(Compiler* compiler);
 
+/**
+ * @brief Cheap hash for the identifier cache. Only looks at the length and a
+ * few characters; collisions are resolved by comparing the full name.
+ *
+ */
+static inline uint32_t hashIdentifier(const char* start, int length) {
+    return (uint32_t)length*31u +
+           (uint32_t)(unsigned char)start[0]*7u +
+           (uint32_t)(unsigned char)start[length/2]*3u +
+           (uint32_t)(unsigned char)start[length-1];
+}
+
+/**
+ * @brief Method to look up (or insert) an identifier in the parser's
+ * compile-time cache.
+ *
+ * @param parser Parser owning the cache
+ * @param name Identifier token
+ * @return CachedIdentifier* The cache entry, or NULL if the cache is full
+ */
+static CachedIdentifier* cachedIdentifier(Parser* parser, Token* name) {
+    uint32_t index = hashIdentifier(name->start, name->length) &
+                     (IDENTIFIER_CACHE_MAX-1);
+    for (;;) {
+        CachedIdentifier* entry = &parser->identifiers[index];
+        if (entry->name == NULL) break;
+        if (entry->name->length == name->length &&
+            memcmp(entry->name->chars, name->start, name->length) == 0) {
+            return entry;
+        }
+        index = (index+1) & (IDENTIFIER_CACHE_MAX-1);
+    }
+
+    // keeping the load factor low so probes stay short
+    if (parser->identifierCount+1 > IDENTIFIER_CACHE_MAX*3/4) return NULL;
+
+    ObjString* string = copyString(parser->vm, name->start, name->length);
+    CachedIdentifier* entry = &parser->identifiers[index];
+    entry->name = string;
+    entry->owner = NULL;
+    entry->constant = 0;
+    entry->isGlobal = -1;
+    entry->isConst = false;
+    entry->hasValue = false;
+    entry->value = NULL_VAL;
+    parser->identifierCount++;
+    return entry;
+}
+
 /**
  * @brief Method to write the constant name as a string to the table
  *
@@ -348,9 +463,21 @@ static uint8_t argumentList(Compiler* compiler);
  * @return uint8_t index of the constant in the program
  */
 static uint8_t identifierConstant(Compiler* compiler, Token* name) {
-    return makeConstant(compiler, OBJ_VAL(copyString(compiler->parser->vm,
-                                                     name->start,
-                                                     name->length)));
+    CachedIdentifier* entry = cachedIdentifier(compiler->parser, name);
+    if (entry == NULL) {
+        return makeConstant(compiler, OBJ_VAL(copyString(compiler->parser->vm,
+                                                         name->start,
+                                                         name->length)));
+    }
+
+    // reuse the slot if this function already holds the name
+    if (entry->owner == compiler->function) return entry->constant;
+    entry->constant = makeConstant(compiler, OBJ_VAL(entry->name));
+    entry->owner = compiler->function;
+
+    // the slot is shared from now on, so folding must not drop it
+    compiler->constantFloor = currentChunk(compiler)->constants.count;
+    return entry->constant;
 }
 
 /**
@@ -463,6 +590,31 @@ static ResolvedVar resolveUpvalue(Compiler* compiler, Token* name) {
     return out;
 }
 
+/**
+ * @brief Method to look up a constant with a literal value declared in one
+ * of the surrounding functions. Follows the same visibility rules as
+ * resolveUpvalue.
+ *
+ * @param value Output for the constant value
+ * @return bool True if the name resolves to such a constant
+ */
+static bool enclosingConstant(Compiler* compiler, Token* name, Value* value) {
+    for (Compiler* outer = compiler->enclosing; outer != NULL;
+         outer = outer->enclosing) {
+        for (int i = outer->localCount-1; i >= 0; i--) {
+            Local* local = &outer->locals[i];
+            if (!identifiersEqual(name, &local->name)) continue;
+
+            if (local->isScoped || !local->isConst || !local->hasValue) {
+                return false;
+            }
+            *value = local->value;
+            return true;
+        }
+    }
+    return false;
+}
+
 /**
  * @brief Method to add a local variable to the compiler locals stack
  *
@@ -480,6 +632,187 @@ static void addLocal(Compiler* compiler, Token name, bool isConst, bool isScoped
     local->isConst = isConst;
     local->isScoped = isScoped;
     local->isCaptured = false;
+    local->hasValue = false;
+}
+
+/**
+ * @brief Method to emit the instruction that pushes a known value
+ *
+ * @param value Value to push
+ */
+static void emitValue(Compiler* compiler, Value value) {
+    if (IS_NULL(value)) {
+        emitByte(compiler, OP_NULL);
+    } else if (IS_BOOL(value)) {
+        emitByte(compiler, AS_BOOL(value) ? OP_TRUE : OP_FALSE);
+    } else {
+        emitConstant(compiler, value);
+    }
+}
+
+/**
+ * @brief Method to read back the value of the code in [start, end) if it is
+ * a single constant instruction.
+ *
+ * @param value Output for the constant value
+ * @return bool True if the span is exactly one constant instruction
+ */
+static bool constantOperand(Compiler* compiler, int start, int end,
+                            Value* value) {
+    Chunk* chunk = currentChunk(compiler);
+    if (end - start == 1) {
+        switch (chunk->code[start]) {
+            case OP_NULL:  *value = NULL_VAL; return true;
+            case OP_TRUE:  *value = BOOL_VAL(true); return true;
+            case OP_FALSE: *value = BOOL_VAL(false); return true;
+            default:       return false;
+        }
+    }
+    if (end - start == 2 && chunk->code[start] == OP_CONSTANT) {
+        *value = chunk->constants.values[chunk->code[start+1]];
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Method to replace the constant operands emitted from `start`
+ * onwards with a single folded value. Pool entries that only the dropped
+ * operands used are removed again.
+ *
+ * @param start Offset of the first operand instruction
+ * @param value The folded value
+ */
+static void emitFolded(Compiler* compiler, int start, Value value) {
+    Chunk* chunk = currentChunk(compiler);
+    VM* vm = compiler->parser->vm;
+    push(vm, value); // the folded value may be a fresh string
+
+    int used[2];
+    int usedCount = 0;
+    for (int i = start; i < chunk->count; ) {
+        if (chunk->code[i] == OP_CONSTANT) {
+            if (usedCount < 2) used[usedCount++] = chunk->code[i+1];
+            i += 2;
+        } else {
+            i++;
+        }
+    }
+    chunk->count = start;
+
+    while (chunk->constants.count > compiler->constantFloor) {
+        int last = chunk->constants.count-1;
+        bool dropped = false;
+        for (int i = 0; i < usedCount; i++) {
+            if (used[i] == last) dropped = true;
+        }
+        if (!dropped) break;
+        chunk->constants.count--;
+    }
+
+    emitValue(compiler, value);
+    pop(vm);
+}
+
+/**
+ * @brief Method to concatenate two constant operands the way OP_ADD does at
+ * runtime. Numbers are formatted with "%g".
+ *
+ * @return Value The interned result string
+ */
+static Value concatenateConstants(Compiler* compiler, Value a, Value b) {
+    Value operands[2] = {a, b};
+    char buffers[2][32];
+    const char* chars[2];
+    int lengths[2];
+    for (int i = 0; i < 2; i++) {
+        if (IS_STRING(operands[i])) {
+            chars[i] = AS_STRING(operands[i])->chars;
+            lengths[i] = AS_STRING(operands[i])->length;
+        } else {
+            lengths[i] = snprintf(buffers[i], sizeof(buffers[i]), "%g",
+                                  AS_NUMBER(operands[i]));
+            chars[i] = buffers[i];
+        }
+    }
+
+    VM* vm = compiler->parser->vm;
+    int length = lengths[0] + lengths[1];
+    char* result = ALLOCATE(vm, char, length+1);
+    memcpy(result, chars[0], lengths[0]);
+    memcpy(result + lengths[0], chars[1], lengths[1]);
+    result[length] = '\0';
+    return OBJ_VAL(takeString(vm, result, length));
+}
+
+/**
+ * @brief Method to evaluate a binary operation on constant operands at
+ * compile time. Operations that would raise a runtime error are left alone.
+ *
+ * @param operatorType Operator token
+ * @param out Output for the folded value
+ * @return bool True if the operation was folded
+ */
+static bool foldBinary(Compiler* compiler, Tokentype operatorType,
+                       Value a, Value b, Value* out) {
+    bool numbers = IS_NUMBER(a) && IS_NUMBER(b);
+    switch (operatorType) {
+        case TOKEN_EQUAL_EQUAL: *out = BOOL_VAL(valuesEqual(a, b)); return true;
+        case TOKEN_BANG_EQUAL:  *out = BOOL_VAL(!valuesEqual(a, b)); return true;
+        default: break;
+    }
+    if (operatorType == TOKEN_PLUS && !numbers) {
+        if ((IS_STRING(a) && (IS_STRING(b) || IS_NUMBER(b))) ||
+            (IS_NUMBER(a) && IS_STRING(b))) {
+            *out = concatenateConstants(compiler, a, b);
+            return true;
+        }
+        return false;
+    }
+    if (!numbers) return false;
+
+    // ints follow the same promotion rules as the VM
+    if (IS_INT(a) && IS_INT(b)) {
+        int64_t i = AS_INT(a);
+        int64_t j = AS_INT(b);
+        switch (operatorType) {
+            case TOKEN_PLUS:  *out = intToValue(i + j); return true;
+            case TOKEN_MINUS: *out = intToValue(i - j); return true;
+            case TOKEN_STAR:  *out = intProduct(i, j); return true;
+            case TOKEN_MOD:
+                if (j == 0) return false;
+                *out = INT_VAL(j == -1 ? 0 : i % j);
+                return true;
+            default: break;
+        }
+    }
+
+    double x = AS_NUMBER(a);
+    double y = AS_NUMBER(b);
+    switch (operatorType) {
+        case TOKEN_GREATER:       *out = BOOL_VAL(x > y); return true;
+        case TOKEN_GREATER_EQUAL: *out = BOOL_VAL(!(x < y)); return true;
+        case TOKEN_LESS:          *out = BOOL_VAL(x < y); return true;
+        case TOKEN_LESS_EQUAL:    *out = BOOL_VAL(!(x > y)); return true;
+
+        case TOKEN_PLUS:          *out = NUMBER_VAL(x + y); return true;
+        case TOKEN_MINUS:         *out = NUMBER_VAL(x - y); return true;
+        case TOKEN_STAR:          *out = NUMBER_VAL(x * y); return true;
+        case TOKEN_SLASH:         *out = NUMBER_VAL(x / y); return true;
+        case TOKEN_MOD:
+            // only integers in int range, and never divide by zero. The
+            // range goes first, as casting anything outside it to int is
+            // undefined, and is written so that NaN fails it too
+            if (!(x > INT_MIN && x <= INT_MAX) ||
+                !(y > INT_MIN && y <= INT_MAX)) {
+                return false;
+            }
+            if (x != (int)x || y != (int)y || y == 0) return false;
+            *out = INT_VAL((int)x % (int)y);
+            return true;
+
+        default: return false;
+    }
 }
 
 /**
@@ -488,10 +821,22 @@ static void addLocal(Compiler* compiler, Token name, bool isConst, bool isScoped
  */
 static void binary(Compiler* compiler, bool canAssign) {
     UNUSED(canAssign);
+    int leftStart = compiler->operandStart;
+    int rightStart = currentChunk(compiler)->count;
     Tokentype operatorType = compiler->parser->previous.type;
     ParseRule* rule = getRule(operatorType);
     parsePrecedence(compiler, (Precedence)(rule->precedence + 1) );
 
+    // folding operations on constant operands
+    Value left, right, folded;
+    if (constantOperand(compiler, leftStart, rightStart, &left) &&
+        constantOperand(compiler, rightStart, currentChunk(compiler)->count,
+                        &right) &&
+        foldBinary(compiler, operatorType, left, right, &folded)) {
+        emitFolded(compiler, leftStart, folded);
+        return;
+    }
+
     switch (operatorType) {
         // logic oper
         case TOKEN_BANG_EQUAL:    emitBytes(compiler, OP_EQUAL, OP_NOT); break;
@@ -520,6 +865,17 @@ static void binary(Compiler* compiler, bool canAssign) {
  */
 static void call(Compiler* compiler, bool canAssign) {
     UNUSED(canAssign);
+    Chunk* chunk = currentChunk(compiler);
+
+    // a method that is called straight away is invoked instead of bound
+    if (compiler->lastProperty >= 0 &&
+        compiler->lastProperty == chunk->count - 2) {
+        uint8_t name = chunk->code[chunk->count - 1];
+        chunk->count -= 2;
+        uint8_t argCount = argumentList(compiler);
+        emitInvoke(compiler, OP_INVOKE, name, argCount);
+        return;
+    }
     uint8_t argCount = argumentList(compiler);
     emitBytes(compiler, OP_CALL, argCount);
 }
@@ -569,9 +925,9 @@ static void dot(Compiler* compiler, bool canAssign) {
 
     } else if (match(compiler, TOKEN_LEFT_PAREN)) {
         uint8_t argCount = argumentList(compiler);
-        emitBytes(compiler, OP_INVOKE, name);
-        emitByte(compiler, argCount);
+        emitInvoke(compiler, OP_INVOKE, name, argCount);
     } else {
+        compiler->lastProperty = currentChunk(compiler)->count;
         emitBytes(compiler, OP_GET_PROPERTY, name);
     }
 }
@@ -610,7 +966,15 @@ static void grouping(Compiler* compiler, bool canAssign) {
  */
 static void number(Compiler* compiler, bool canAssign) {
     UNUSED(canAssign);
-    double value = strtod(compiler->parser->previous.start, NULL);
+    Token* token = &compiler->parser->previous;
+    double value = strtod(token->start, NULL);
+
+    // literals written without a fraction are ints when they fit
+    if (memchr(token->start, '.', token->length) == NULL &&
+        value >= INT32_MIN && value <= INT32_MAX) {
+        emitConstant(compiler, INT_VAL((int32_t)value));
+        return;
+    }
     emitConstant(compiler, NUMBER_VAL(value));
 }
 
@@ -724,6 +1088,24 @@ static void string(Compiler* compiler, bool canAssign) {
     emitConstant(compiler, parseString(compiler, canAssign));
 }
 
+/**
+ * @brief Method to check if a name refers to a global (native) binding. The
+ * result is remembered in the identifier cache.
+ *
+ */
+static bool isNativeGlobal(Parser* parser, CachedIdentifier* entry,
+                           Token* name) {
+    Value value;
+    if (entry == NULL) {
+        ObjString* string = copyString(parser->vm, name->start, name->length);
+        return tableGet(&parser->vm->globals, string, &value);
+    }
+    if (entry->isGlobal == -1) {
+        entry->isGlobal = tableGet(&parser->vm->globals, entry->name, &value);
+    }
+    return entry->isGlobal;
+}
+
 /**
  * @brief TODO add comment here
  *
@@ -735,10 +1117,21 @@ static void namedVariable(Compiler* compiler, Token name, bool canAssign) {
     int arg = resLoc.depth;
     bool isConst = resLoc.isConst;
     bool isScoped = resLoc.isScoped;
+    bool hasValue = false; // constant with a literal value
+    Value value = NULL_VAL;
 
     if (arg != -1) { // -1 for global state
         getOp = OP_GET_LOCAL;
         setOp = OP_SET_LOCAL;
+        hasValue = compiler->locals[arg].hasValue;
+        value = compiler->locals[arg].value;
+    } else if (!isScoped && enclosingConstant(compiler, &name, &value)) {
+        // literal constant of a surrounding function, no capture needed
+        getOp = OP_GET_UPVALUE;
+        setOp = OP_SET_UPVALUE;
+        arg = 0;
+        isConst = true;
+        hasValue = true;
     } else if ( !isScoped &&
                 (arg = resolveUpvalue(compiler, &name).depth) != -1) {
         isConst = resolveUpvalue(compiler, &name).isConst;
@@ -748,14 +1141,18 @@ static void namedVariable(Compiler* compiler, Token name, bool canAssign) {
         arg = identifierConstant(compiler, &name);
         /* getOp = OP_GET_GLOBAL;
         setOp = OP_SET_GLOBAL; */
-        ObjString* string = copyString(compiler->parser->vm, name.start, name.length);
-        Value value;
-        if (tableGet(&compiler->parser->vm->globals, string, &value)) {
+        CachedIdentifier* entry = cachedIdentifier(compiler->parser, &name);
+        if (isNativeGlobal(compiler->parser, entry, &name)) {
             getOp = OP_GET_GLOBAL;
             canAssign = false;
         } else {
             getOp = OP_GET_MODULE;
             setOp = OP_SET_MODULE;
+            if (entry != NULL) {
+                isConst = entry->isConst;
+                hasValue = entry->hasValue;
+                value = entry->value;
+            }
         }
     }
 
@@ -812,6 +1209,8 @@ static void namedVariable(Compiler* compiler, Token name, bool canAssign) {
         expression(compiler);
         emitByte(compiler, OP_DIVIDE);
         emitBytes(compiler, setOp, (uint8_t)arg);
+    } else if (hasValue) {
+        emitValue(compiler, value);
     } else {
         emitBytes(compiler, getOp, (uint8_t)arg);
     }
@@ -858,8 +1257,7 @@ static void super_(Compiler* compiler, bool canAssign) {
     if (match(compiler, TOKEN_LEFT_PAREN)) {
         uint8_t argCount = argumentList(compiler);
         namedVariable(compiler, syntheticToken("super"), false);
-        emitBytes(compiler, OP_SUPER_INVOKE, name);
-        emitByte(compiler, argCount);
+        emitInvoke(compiler, OP_SUPER_INVOKE, name, argCount);
     } else {
         namedVariable(compiler, syntheticToken("super"), false);
         emitBytes(compiler, OP_GET_SUPER, name);
@@ -888,10 +1286,28 @@ static void this_(Compiler* compiler, bool canAssign) {
 static void unary(Compiler* compiler, bool canAssign) {
     UNUSED(canAssign);
     Tokentype operatorType = compiler->parser->previous.type;
+    int start = currentChunk(compiler)->count;
 
     // compiling the operand
     parsePrecedence(compiler, PREC_UNARY);
 
+    // folding constant operands
+    Value operand;
+    if (constantOperand(compiler, start, currentChunk(compiler)->count,
+                        &operand)) {
+        if (operatorType == TOKEN_BANG) {
+            emitFolded(compiler, start, BOOL_VAL(IS_NULL(operand) ||
+                       (IS_BOOL(operand) && !AS_BOOL(operand))));
+            return;
+        }
+        if (operatorType == TOKEN_MINUS && IS_NUMBER(operand)) {
+            emitFolded(compiler, start, IS_INT(operand) ?
+                       intNegation(AS_INT(operand)) :
+                       NUMBER_VAL(-AS_NUMBER(operand)));
+            return;
+        }
+    }
+
     // emit operator instruction
     switch (operatorType) {
         case TOKEN_BANG:  emitByte(compiler, OP_NOT); break;
@@ -930,6 +1346,7 @@ static void list(Compiler* compiler, bool canAssign) {
             if (check(compiler, TOKEN_RIGHT_BRACKET))
                 break;
             parsePrecedence(compiler, PREC_OR);
+            if (numElem == 255) error(compiler->parser, "Can't have more than 255 items in a list literal.");
             numElem++;
         } while(match(compiler, TOKEN_COMMA));
     }
@@ -937,8 +1354,55 @@ static void list(Compiler* compiler, bool canAssign) {
     emitBytes(compiler, OP_MAKE_LIST, numElem);
 }
 
+/**
+ * @brief Method to compile a map literal `{key: value, ...}`. The keys and
+ * values are pushed in pairs and collected by one instruction.
+ *
+ */
+static void map(Compiler* compiler, bool canAssign) {
+    UNUSED(canAssign);
+    int numPairs = 0;
+    if (!check(compiler, TOKEN_RIGHT_BRACE)) {
+        do {
+            if (check(compiler, TOKEN_RIGHT_BRACE))
+                break;
+            parsePrecedence(compiler, PREC_OR);
+            consume(compiler, TOKEN_COLON, "Expect ':' after map key.");
+            parsePrecedence(compiler, PREC_OR);
+            if (numPairs == 255) error(compiler->parser, "Can't have more than 255 entries in a map literal.");
+            numPairs++;
+        } while(match(compiler, TOKEN_COMMA));
+    }
+    consume(compiler, TOKEN_RIGHT_BRACE, "Expect '}' after map entries.");
+    emitBytes(compiler, OP_MAKE_MAP, numPairs);
+}
+
+/**
+ * @brief Method to compile the rest of a slice `[start:end]` once the start
+ * bound is on the stack. A missing end bound is compiled as null.
+ *
+ */
+static void slice(Compiler* compiler) {
+    if (check(compiler, TOKEN_RIGHT_BRACKET)) {
+        emitByte(compiler, OP_NULL);
+    } else {
+        parsePrecedence(compiler, PREC_OR);
+    }
+    consume(compiler, TOKEN_RIGHT_BRACKET, "Expect ']' after slice.");
+    emitByte(compiler, OP_SLICE);
+}
+
 static void subscript(Compiler* compiler, bool canAssign) {
+    if (match(compiler, TOKEN_COLON)) {
+        emitByte(compiler, OP_NULL);
+        slice(compiler);
+        return;
+    }
     parsePrecedence(compiler, PREC_OR);
+    if (match(compiler, TOKEN_COLON)) {
+        slice(compiler);
+        return;
+    }
 
     consume(compiler, TOKEN_RIGHT_BRACKET, "Expected ']' after subscript.");
     if (canAssign && match(compiler, TOKEN_EQUAL)) {
@@ -979,7 +1443,7 @@ static void subscript(Compiler* compiler, bool canAssign) {
 ParseRule rules[] = {
     [TOKEN_LEFT_PAREN]    = {grouping, call,   PREC_CALL},
     [TOKEN_RIGHT_PAREN]   = {NULL,     NULL,   PREC_NONE},
-    [TOKEN_LEFT_BRACE]    = {NULL,     NULL,   PREC_NONE}, 
+    [TOKEN_LEFT_BRACE]    = {map,      NULL,   PREC_NONE}, 
     [TOKEN_RIGHT_BRACE]   = {NULL,     NULL,   PREC_NONE},
     [TOKEN_LEFT_BRACKET]  = {list,     subscript,   PREC_SUBSCRIPT}, 
     [TOKEN_RIGHT_BRACKET] = {NULL,     NULL,   PREC_NONE}, 
@@ -1050,11 +1514,13 @@ static void parsePrecedence(Compiler* compiler, Precedence precedence) {
 
     // checking if assignment can happen
     bool canAssign = precedence <= PREC_ASSIGNMENT;
+    int start = currentChunk(compiler)->count;
     prefixRule(compiler, canAssign);
 
     while (precedence <= getRule(compiler->parser->current.type)->precedence) {
         advance(compiler->parser);
         ParseFn infixRule = getRule(compiler->parser->previous.type)->infix;
+        compiler->operandStart = start; // left operand for binary()
         infixRule(compiler, canAssign);
     }
 
@@ -1069,9 +1535,15 @@ static void parsePrecedence(Compiler* compiler, Precedence precedence) {
  * 
  */
 static void declareVariable(Compiler* compiler, bool isConst, bool isScoped) {
-    if (compiler->scopeDepth == 0) return; // if at global scope, return
-
     Token* name = &compiler->parser->previous;
+    if (compiler->scopeDepth == 0) { // if at global scope, return
+        CachedIdentifier* entry = cachedIdentifier(compiler->parser, name);
+        if (entry != NULL && entry->isConst) {
+            error(compiler->parser, "Cannot redeclare constants.");
+        }
+        return;
+    }
+
     for (int i = compiler->localCount-1; i>=0; i--) {
         Local* local = &compiler->locals[i];
         if (local->depth != -1 && local->depth < compiler->scopeDepth) {
@@ -1323,14 +1795,34 @@ static void varDeclaration(Compiler* compiler, bool isScoped) {
 
 static void constDeclaration(Compiler* compiler, bool isScoped) {
     uint8_t global = parseVariable(compiler, "Expect variable name.", true, isScoped);
+    Token name = compiler->parser->previous;
 
+    bool hasValue = false;
+    Value value = NULL_VAL;
     if (!match(compiler, TOKEN_EQUAL)) {
         error(compiler->parser, "Constant declarations must be followed by a value assignment.");
     } else {
+        int start = currentChunk(compiler)->count;
         expression(compiler);
+        hasValue = constantOperand(compiler, start,
+                                   currentChunk(compiler)->count, &value);
     }
     consume(compiler, TOKEN_SEMICOLON, "Expect ';' after constant declaration");
 
+    // remembering literal values so later reads can be folded
+    if (compiler->scopeDepth > 0) {
+        Local* local = &compiler->locals[compiler->localCount-1];
+        local->hasValue = hasValue;
+        local->value = value;
+    } else {
+        CachedIdentifier* entry = cachedIdentifier(compiler->parser, &name);
+        if (entry != NULL) {
+            entry->isConst = true;
+            entry->hasValue = hasValue;
+            entry->value = value;
+        }
+    }
+
     defineVariable(compiler, global);
 }
 
@@ -1344,84 +1836,6 @@ static void expressionStatement(Compiler* compiler) {
     emitByte(compiler, OP_POP);
 }
 
-/**
- * @brief Method to get the argument count of a given OpCode
- *
- * @param code 
- * @param constants 
- * @param ip 
- * @return 
- */
-static int getArgCount(const uint8_t *code, const ValueArray constants, int ip) {
-    switch (code[ip]) {
-        case OP_NULL:
-        case OP_TRUE:
-        case OP_FALSE:
-        case OP_POP:
-        case OP_EQUAL:
-        case OP_GREATER:
-        case OP_LESS:
-        case OP_ADD:
-        case OP_SUBTRACT:
-        case OP_MULTIPLY:
-        case OP_DIVIDE:
-        case OP_MOD:
-        case OP_NOT:
-        case OP_NEGATE:
-        case OP_CLOSE_UPVALUE:
-        case OP_RETURN:
-        case OP_END_CLASS:
-        case OP_BREAK:
-        case OP_INCREMENT:
-        case OP_DECREMENT:
-        case OP_MODULE_VAR:
-        case OP_MODULE_END:
-        case OP_MAKE_LIST:
-        case OP_SUBSCRIPT_IDX:
-        case OP_SUBSCRIPT_IDX_NOPOP:
-        case OP_SUBSCRIPT_ASSIGN:
-            return 0;
-
-        case OP_CONSTANT:
-        case OP_GET_LOCAL:
-        case OP_SET_LOCAL:
-        case OP_GET_GLOBAL:
-        case OP_GET_MODULE:
-        case OP_SET_MODULE:
-        case OP_DEFINE_MODULE:
-        case OP_GET_UPVALUE:
-        case OP_SET_UPVALUE:
-        case OP_GET_PROPERTY:
-        case OP_SET_PROPERTY:
-        case OP_GET_SUPER:
-        case OP_METHOD:
-        case OP_MODULE:
-            return 1;
-
-        case OP_JUMP:
-        case OP_JUMP_IF_FALSE:
-        case OP_LOOP:
-        case OP_CLASS:
-        case OP_INHERIT:
-        case OP_CALL:
-        case OP_MODULE_BUILTIN:
-            return 2;
-
-        case OP_INVOKE:
-        case OP_SUPER_INVOKE:
-            return 3;
-
-        case OP_CLOSURE: {
-            int constant = code[ip + 1];
-            ObjFunction* loadedFn = AS_FUNCTION(constants.values[constant]);
-
-            // There is one byte for the constant, then two for each upvalue.
-            return 1 + (loadedFn->upvalueCount * 2);
-        }
-    }
-
-    return 0;
-}
 /**
  * @brief Method to end a loop
  *
@@ -1432,25 +1846,148 @@ static void endLoop(Compiler* compiler) {
         emitByte(compiler, OP_POP);
     }
 
-    int i = compiler->loop->body;
-    while (i < compiler->function->chunk.count) {
-        if (compiler->function->chunk.code[i] == OP_BREAK) {
-            compiler->function->chunk.code[i] = OP_JUMP;
-            patchJump(compiler, i+1);
-            i+=3;
-        } else {
-            i += 1 + getArgCount(compiler->function->chunk.code,
-                                 compiler->function->chunk.constants, i);
-        }
+    // every break jumps to just past the loop
+    for (int i = 0; i < compiler->loop->breakCount; i++) {
+        patchJump(compiler, compiler->loop->breaks[i]);
     }
+    FREE_ARRAY(compiler->parser->vm, int, compiler->loop->breaks,
+               compiler->loop->breakCapacity);
     compiler->loop = compiler->loop->enclosing;
 }
+/**
+ * @brief Method to check for the word `in`. It is only special right after
+ * the loop variable of a for-in loop, so it can still be used as a name.
+ *
+ */
+static bool isInWord(Token token) {
+    return token.type == TOKEN_IDENTIFIER && token.length == 2 &&
+           memcmp(token.start, "in", 2) == 0;
+}
+
+/**
+ * @brief Method to check if a for statement is a for-in loop by scanning
+ * ahead for `var name in` without consuming any tokens
+ *
+ */
+static bool isForIn(Parser* parser) {
+    Scanner lookahead = parser->scanner;
+    if (parser->current.type == TOKEN_VAR) {
+        if (scanToken(&lookahead).type != TOKEN_IDENTIFIER) return false;
+    } else if (parser->current.type != TOKEN_IDENTIFIER) {
+        return false;
+    }
+    return isInWord(scanToken(&lookahead));
+}
+
+/**
+ * @brief Method to store the value on top of the stack into an existing
+ * variable, resolving the name the same way namedVariable does. The value
+ * is left on the stack.
+ *
+ * @param name The name of the variable to assign to
+ */
+static void assignVariable(Compiler* compiler, Token name) {
+    uint8_t setOp;
+    ResolvedVar resolved = resolveLocal(compiler, &name);
+    int arg = resolved.depth;
+    bool isConst = resolved.isConst;
+    Value value;
+
+    if (arg != -1) {
+        setOp = OP_SET_LOCAL;
+    } else if (!resolved.isScoped &&
+               enclosingConstant(compiler, &name, &value)) {
+        setOp = OP_SET_UPVALUE;
+        arg = 0;
+        isConst = true;
+    } else if (!resolved.isScoped &&
+               (arg = resolveUpvalue(compiler, &name).depth) != -1) {
+        isConst = resolveUpvalue(compiler, &name).isConst;
+        setOp = OP_SET_UPVALUE;
+    } else {
+        arg = identifierConstant(compiler, &name);
+        CachedIdentifier* entry = cachedIdentifier(compiler->parser, &name);
+        if (isNativeGlobal(compiler->parser, entry, &name)) {
+            error(compiler->parser, "Invalid assignment target.");
+            return;
+        }
+        setOp = OP_SET_MODULE;
+        if (entry != NULL) isConst = entry->isConst;
+    }
+
+    if (isConst) {
+        error(compiler->parser, "Cannot reassign values to constants.");
+    }
+    emitBytes(compiler, setOp, (uint8_t)arg);
+}
+
+/**
+ * @brief Method to parse through for-in loops, `for (var name in iterable)`
+ * or `for (name in iterable)`. The iterable and the position in it are kept
+ * in two hidden locals. Each step pushes the next value as a fresh loop
+ * variable, or stores it into the existing variable for the second form.
+ */
+static void forInStatement(Compiler* compiler) {
+    bool declared = match(compiler, TOKEN_VAR);
+    consume(compiler, TOKEN_IDENTIFIER, "Expect variable name.");
+    Token name = compiler->parser->previous;
+    // isForIn has already seen the `in`
+    advance(compiler->parser);
+    expression(compiler);
+    consume(compiler, TOKEN_RIGHT_PAREN, "Expect ')' after for clauses.");
+
+    // the names start with a space so that no identifier can refer to them
+    int slot = compiler->localCount;
+    addLocal(compiler, syntheticToken(" iterable"), false, false);
+    markInitialized(compiler);
+    emitByte(compiler, OP_ITER_INIT);
+    addLocal(compiler, syntheticToken(" index"), false, false);
+    markInitialized(compiler);
+
+    Loop loop;
+    loop.start = currentChunk(compiler)->count;
+    loop.scopeDepth = compiler->scopeDepth;
+    loop.breaks = NULL;
+    loop.breakCount = 0;
+    loop.breakCapacity = 0;
+    loop.enclosing = compiler->loop;
+    loop.end = -1;
+    compiler->loop = &loop;
+
+    emitBytes(compiler, OP_ITER_NEXT, (uint8_t)slot);
+    emitByte(compiler, 0xff);
+    emitByte(compiler, 0xff);
+    int exitJump = currentChunk(compiler)->count - 2;
+
+    beginScope(compiler);
+    if (declared) {
+        addLocal(compiler, name, false, false);
+        markInitialized(compiler);
+    } else {
+        addLocal(compiler, syntheticToken(" value"), false, false);
+        markInitialized(compiler);
+        assignVariable(compiler, name);
+    }
+    compiler->loop->body = compiler->function->chunk.count;
+    statement(compiler);
+    endScope(compiler);
+    emitLoop(compiler, loop.start);
+
+    patchJump(compiler, exitJump);
+    endLoop(compiler);
+}
+
 /**
  * @brief Method to parse through for statements
  */
 static void forStatement(Compiler* compiler) {
     beginScope(compiler);
     consume(compiler, TOKEN_LEFT_PAREN, "Expect '(' after 'for'.");
+    if (isForIn(compiler->parser)) {
+        forInStatement(compiler);
+        endScope(compiler);
+        return;
+    }
 
     // init clause
     if(match(compiler, TOKEN_SEMICOLON)) {
@@ -1464,6 +2001,9 @@ static void forStatement(Compiler* compiler) {
     Loop loop;
     loop.start = currentChunk(compiler)->count;
     loop.scopeDepth = compiler->scopeDepth;
+    loop.breaks = NULL;
+    loop.breakCount = 0;
+    loop.breakCapacity = 0;
     loop.enclosing = compiler->loop;
     compiler->loop = &loop;
 
@@ -1517,7 +2057,14 @@ static void breakStatement(Compiler* compiler) {
             emitByte(compiler, OP_POP);
         }
     }
-    emitJump(compiler, OP_BREAK);
+    Loop* loop = compiler->loop;
+    if (loop->breakCapacity < loop->breakCount + 1) {
+        int oldCapacity = loop->breakCapacity;
+        loop->breakCapacity = GROW_CAPACITY(oldCapacity);
+        loop->breaks = GROW_ARRAY(compiler->parser->vm, int, loop->breaks,
+                                  oldCapacity, loop->breakCapacity);
+    }
+    loop->breaks[loop->breakCount++] = emitJump(compiler, OP_JUMP);
 }
 
 static void continueStatement(Compiler* compiler) {
@@ -1654,6 +2201,9 @@ static void whileStatement(Compiler* compiler) {
     Loop loop;
     loop.start = currentChunk(compiler)->count;
     loop.scopeDepth = compiler->scopeDepth;
+    loop.breaks = NULL;
+    loop.breakCount = 0;
+    loop.breakCapacity = 0;
     loop.enclosing = compiler->loop;
     compiler->loop = &loop;
 
@@ -1767,6 +2317,8 @@ ObjFunction* compile(VM* vm, ObjModule* module, const char *source) {
     parser.hadError = false;
     parser.panicMode = false;
     parser.module = module;
+    parser.identifierCount = 0;
+    memset(parser.identifiers, 0, sizeof(parser.identifiers));
 
     Scanner scanner;
     initScanner(&scanner, source);
@@ -1787,6 +2339,13 @@ ObjFunction* compile(VM* vm, ObjModule* module, const char *source) {
 
 void markCompilerRoots(VM* vm) {
     Compiler* compiler = vm->compiler;
+    if (compiler == NULL) return;
+
+    Parser* parser = compiler->parser;
+    for (int i = 0; i < IDENTIFIER_CACHE_MAX; i++) {
+        markObject(vm, (Obj*)parser->identifiers[i].name);
+        markValue(vm, parser->identifiers[i].value);
+    }
     while (compiler != NULL) {
         markObject(vm, (Obj*)compiler->function);
         compiler = compiler->enclosing;
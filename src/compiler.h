@@ -4,6 +4,25 @@
 #include "object.h"
 #include "scanner.h"
 
+#define IDENTIFIER_CACHE_MAX 512
+
+/**
+ * @brief Compile-time cache entry for an identifier. Holds the interned
+ * string so repeated references skip hashing and interning, along with the
+ * last constant slot it was written to.
+ *
+ */
+typedef struct {
+    ObjString* name;
+    ObjFunction* owner; // function whose constant table holds `constant`
+    uint8_t constant;
+    int8_t isGlobal;    // -1 if unknown, else whether the name is a native
+
+    bool isConst;       // module-level constant
+    bool hasValue;      // constant initialized with a literal, held in `value`
+    Value value;
+} CachedIdentifier;
+
 /**
  * @brief Parser struct to hold the current and previous parser
  *
@@ -17,6 +36,9 @@ typedef struct {
     bool hadError;     // if the parser encountered an error during parsing
     bool panicMode;    // set panicMode to unwind out of the parser code
     ObjModule* module; // Module object
+
+    CachedIdentifier identifiers[IDENTIFIER_CACHE_MAX];
+    int identifierCount;
 } Parser;
 
 typedef enum {
@@ -45,6 +67,9 @@ typedef struct {
     bool isConst;    // if variable is declared constant
     bool isScoped;   // if variable is strictly local
     bool isCaptured; // true if local is captured by any later nested func dec
+
+    bool hasValue;   // constant initialized with a literal, held in `value`
+    Value value;
 } Local;
 
 typedef struct {
@@ -72,6 +97,10 @@ typedef struct Loop {
     int body;
     int end;
     int scopeDepth;
+
+    int* breaks; // offsets of break jumps awaiting the loop end
+    int breakCount;
+    int breakCapacity;
 } Loop;
 
 /**
@@ -105,6 +134,10 @@ typedef struct Compiler {
 
     Upvalue upvalues[UINT8_COUNT]; // Upvalue array
     int scopeDepth;                // The depth of the scope (0 for global)
+
+    int operandStart;              // Offset where the left operand begins
+    int constantFloor;             // Constants below this may be shared
+    int lastProperty;              // Offset of the last property get, or -1
 } Compiler;
 
 /**
@@ -37,7 +37,7 @@ static int invokeInstruction(const char* name, Chunk* chunk, int offset) {
     printf("\033[0;32m%-16s\033[0m (%d args) %4d '", name, argCount, constant);
     printValue(stdout, chunk->constants.values[constant]);
     printf("'\n");
-    return offset+3;
+    return offset+5;
 }
 
 /**
@@ -68,6 +68,32 @@ static int byteInstruction(const char* name, Chunk* chunk, int offset) {
     return offset+2;
 }
 
+/**
+ * @brief Display method for the register-style instructions.
+ *
+ * @param name The name of the operation
+ * @param chunk The current chunk within bytecode
+ * @param offset The current location in code
+ * @param hasDest If the first operand is a destination slot
+ * @param hasConstant If the last operand is a constant index
+ * @return static int The current offset of the code
+ */
+static int registerInstruction(const char* name, Chunk* chunk, int offset,
+                               bool hasDest, bool hasConstant) {
+    int at = offset+1;
+    printf("\033[0;32m%-16s\033[0m ", name);
+    if (hasDest) printf("%4d <- ", chunk->code[at++]);
+    printf("%4d ", chunk->code[at++]);
+    if (hasConstant) {
+        printf("'");
+        printValue(stdout, chunk->constants.values[chunk->code[at]]);
+        printf("'\n");
+    } else {
+        printf("%4d\n", chunk->code[at]);
+    }
+    return at+1;
+}
+
 /**
  * @brief Method to disassmeble 16-bit operand jump instructions.
  *
@@ -86,6 +112,51 @@ static int jumpInstruction(const char* name, int sign, Chunk* chunk,
     return offset+3;
 }
 
+/**
+ * @brief Display method for the for-in step instruction.
+ *
+ * @param name The name of the operation
+ * @param chunk The current chunk within bytecode
+ * @param offset The current location in code
+ * @return static int The current offset of the code
+ */
+static int iterInstruction(const char* name, Chunk* chunk, int offset) {
+    uint8_t slot = chunk->code[offset+1];
+    uint16_t jump = (uint16_t)(chunk->code[offset+2] << 8);
+    jump |= chunk->code[offset+3];
+    printf("\033[0;32m%-16s\033[0m %4d %4d -> %d\n", name, slot, offset,
+            offset+4+jump);
+    return offset+4;
+}
+
+/**
+ * @brief Display method for the compare-and-branch instructions.
+ *
+ * @param name The name of the operation
+ * @param chunk The current chunk within bytecode
+ * @param offset The current location in code
+ * @param hasConstant If the right operand is a constant index
+ * @return static int The current offset of the code
+ */
+static int branchInstruction(const char* name, Chunk* chunk, int offset,
+                             bool hasConstant) {
+    uint8_t left = chunk->code[offset+1];
+    uint8_t right = chunk->code[offset+2];
+    uint16_t jump = (uint16_t)(chunk->code[offset+3] << 8);
+    jump |= chunk->code[offset+4];
+
+    printf("\033[0;32m%-16s\033[0m %4d ", name, left);
+    if (hasConstant) {
+        printf("'");
+        printValue(stdout, chunk->constants.values[right]);
+        printf("'");
+    } else {
+        printf("%4d", right);
+    }
+    printf(" -> %d\n", offset+5+jump);
+    return offset+5;
+}
+
 int disassembleInstruction(Chunk *chunk, int offset) {
     printf("%04d ", offset);
     if (offset > 0 &&
@@ -110,6 +181,8 @@ int disassembleInstruction(Chunk *chunk, int offset) {
             return byteInstruction("OP_GET_LOCAL", chunk, offset);
         case OP_SET_LOCAL:
             return byteInstruction("OP_SET_LOCAL", chunk, offset);
+        case OP_SET_LOCAL_POP:
+            return byteInstruction("OP_SET_LOCAL_POP", chunk, offset);
         case OP_GET_GLOBAL:
             return constantInstruction("OP_GET_GLOBAL", chunk, offset);
         case OP_DEFINE_GLOBAL:
@@ -135,10 +208,16 @@ int disassembleInstruction(Chunk *chunk, int offset) {
             return constantInstruction("OP_GET_SUPER", chunk, offset);
         case OP_EQUAL:
             return simpleInstruction("OP_EQUAL", offset);
+        case OP_NOT_EQUAL:
+            return simpleInstruction("OP_NOT_EQUAL", offset);
         case OP_GREATER:
             return simpleInstruction("OP_GREATER", offset);
+        case OP_GREATER_EQUAL:
+            return simpleInstruction("OP_GREATER_EQUAL", offset);
         case OP_LESS:
             return simpleInstruction("OP_LESS", offset);
+        case OP_LESS_EQUAL:
+            return simpleInstruction("OP_LESS_EQUAL", offset);
 
         case OP_ADD:
             return simpleInstruction("OP_ADD", offset);
@@ -167,12 +246,16 @@ int disassembleInstruction(Chunk *chunk, int offset) {
 
         case OP_MAKE_LIST:
             return byteInstruction("OP_MAKE_LIST", chunk, offset);
+        case OP_MAKE_MAP:
+            return byteInstruction("OP_MAKE_MAP", chunk, offset);
         case OP_SUBSCRIPT_ASSIGN:
             return simpleInstruction("OP_SUBSCRIPT_ASSIGN", offset);
         case OP_SUBSCRIPT_IDX_NOPOP:
             return simpleInstruction("OP_SUBSCRIPT_IDX_NOPOP", offset);
         case OP_SUBSCRIPT_IDX:
             return simpleInstruction("OP_SUBSCRIPT_IDX", offset);
+        case OP_SLICE:
+            return simpleInstruction("OP_SLICE", offset);
 
         case OP_CONSTANT:
             return constantInstruction("OP_CONSTANT", chunk, offset);
@@ -189,12 +272,22 @@ int disassembleInstruction(Chunk *chunk, int offset) {
             return jumpInstruction("OP_JUMP_IF_FALSE", 1, chunk, offset);
         case OP_LOOP:
             return jumpInstruction("OP_LOOP", -1, chunk, offset);
+        case OP_ITER_INIT:
+            return simpleInstruction("OP_ITER_INIT", offset);
+        case OP_ITER_NEXT:
+            return iterInstruction("OP_ITER_NEXT", chunk, offset);
         case OP_CALL:
             return byteInstruction("OP_CALL", chunk, offset);
         case OP_INVOKE:
             return invokeInstruction("OP_INVOKE", chunk, offset);
         case OP_SUPER_INVOKE:
             return invokeInstruction("OP_SUPER_INVOKE", chunk, offset);
+        case OP_CALL_NATIVE:
+            return byteInstruction("OP_CALL_NATIVE", chunk, offset);
+        case OP_TAIL_CALL:
+            return byteInstruction("OP_TAIL_CALL", chunk, offset);
+        case OP_TAIL_INVOKE:
+            return invokeInstruction("OP_TAIL_INVOKE", chunk, offset);
         case OP_CLOSURE: {
             offset++;
             uint8_t constant = chunk->code[offset++];
@@ -223,6 +316,82 @@ int disassembleInstruction(Chunk *chunk, int offset) {
             return simpleInstruction("OP_INHERIT", offset);
         case OP_METHOD:
             return constantInstruction("OP_METHOD", chunk, offset);
+        case OP_ADD_LL:
+            return registerInstruction("OP_ADD_LL", chunk, offset,
+                                       false, false);
+        case OP_SUBTRACT_LL:
+            return registerInstruction("OP_SUBTRACT_LL", chunk, offset,
+                                       false, false);
+        case OP_MULTIPLY_LL:
+            return registerInstruction("OP_MULTIPLY_LL", chunk, offset,
+                                       false, false);
+        case OP_DIVIDE_LL:
+            return registerInstruction("OP_DIVIDE_LL", chunk, offset,
+                                       false, false);
+        case OP_LESS_LL:
+            return registerInstruction("OP_LESS_LL", chunk, offset,
+                                       false, false);
+        case OP_GREATER_LL:
+            return registerInstruction("OP_GREATER_LL", chunk, offset,
+                                       false, false);
+        case OP_ADD_LC:
+            return registerInstruction("OP_ADD_LC", chunk, offset,
+                                       false, true);
+        case OP_SUBTRACT_LC:
+            return registerInstruction("OP_SUBTRACT_LC", chunk, offset,
+                                       false, true);
+        case OP_MULTIPLY_LC:
+            return registerInstruction("OP_MULTIPLY_LC", chunk, offset,
+                                       false, true);
+        case OP_DIVIDE_LC:
+            return registerInstruction("OP_DIVIDE_LC", chunk, offset,
+                                       false, true);
+        case OP_LESS_LC:
+            return registerInstruction("OP_LESS_LC", chunk, offset,
+                                       false, true);
+        case OP_GREATER_LC:
+            return registerInstruction("OP_GREATER_LC", chunk, offset,
+                                       false, true);
+        case OP_ADD_LL_SET:
+            return registerInstruction("OP_ADD_LL_SET", chunk, offset,
+                                       true, false);
+        case OP_SUBTRACT_LL_SET:
+            return registerInstruction("OP_SUBTRACT_LL_SET", chunk, offset,
+                                       true, false);
+        case OP_MULTIPLY_LL_SET:
+            return registerInstruction("OP_MULTIPLY_LL_SET", chunk, offset,
+                                       true, false);
+        case OP_DIVIDE_LL_SET:
+            return registerInstruction("OP_DIVIDE_LL_SET", chunk, offset,
+                                       true, false);
+        case OP_ADD_LC_SET:
+            return registerInstruction("OP_ADD_LC_SET", chunk, offset,
+                                       true, true);
+        case OP_SUBTRACT_LC_SET:
+            return registerInstruction("OP_SUBTRACT_LC_SET", chunk, offset,
+                                       true, true);
+        case OP_MULTIPLY_LC_SET:
+            return registerInstruction("OP_MULTIPLY_LC_SET", chunk, offset,
+                                       true, true);
+        case OP_DIVIDE_LC_SET:
+            return registerInstruction("OP_DIVIDE_LC_SET", chunk, offset,
+                                       true, true);
+        case OP_INCREMENT_LOCAL:
+            return byteInstruction("OP_INCREMENT_LOCAL", chunk, offset);
+        case OP_DECREMENT_LOCAL:
+            return byteInstruction("OP_DECREMENT_LOCAL", chunk, offset);
+        case OP_JUMP_IF_NOT_LESS_LL:
+            return branchInstruction("OP_JUMP_IF_NOT_LESS_LL", chunk, offset,
+                                     false);
+        case OP_JUMP_IF_NOT_GREATER_LL:
+            return branchInstruction("OP_JUMP_IF_NOT_GREATER_LL", chunk,
+                                     offset, false);
+        case OP_JUMP_IF_NOT_LESS_LC:
+            return branchInstruction("OP_JUMP_IF_NOT_LESS_LC", chunk, offset,
+                                     true);
+        case OP_JUMP_IF_NOT_GREATER_LC:
+            return branchInstruction("OP_JUMP_IF_NOT_GREATER_LC", chunk,
+                                     offset, true);
         default:
             printf("Unknown opcode %d\n", instruction);
             return offset+1;
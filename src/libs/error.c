@@ -7,7 +7,7 @@ static Value errorMethod(VM* vm, int argCount, Value* args) {
     if (argCount < 1) {
         runtimeError(vm, "'Error.print(value, ...)' takes at least one argument (%d provided)",
                      argCount);
-        return INTERPRET_RUNTIME_ERROR;
+        return BAD_VAL;
     }
     fprintf(stderr, "\033[0;31m");
     for (int i = 0; i < argCount; i++) {
@@ -22,7 +22,7 @@ static Value errorlnMethod(VM* vm, int argCount, Value* args) {
     if (argCount < 1) {
         runtimeError(vm, "'Error.println(value, ...)' takes at least one argument (%d provided)",
                      argCount);
-        return INTERPRET_RUNTIME_ERROR;
+        return BAD_VAL;
     }
     fprintf(stderr, "\033[0;31m");
     for (int i = 0; i < argCount; i++) {
@@ -39,8 +39,8 @@ ObjModule* initLib_Error(VM* vm) {
     push(vm, OBJ_VAL(name));
     ObjModule* errorLib = newModule(vm, name);
     push(vm, OBJ_VAL(errorLib));
-    defineNative(vm, &errorLib->values, "print", errorMethod);
-    defineNative(vm, &errorLib->values, "println", errorlnMethod);
+    defineNative(vm, &errorLib->values, "print", ARITY_ANY, errorMethod);
+    defineNative(vm, &errorLib->values, "println", ARITY_ANY, errorlnMethod);
     pop(vm);
     pop(vm);
     return errorLib;
@@ -9,7 +9,7 @@ static Value printMethod(VM* vm, int argCount, Value* args) {
     if (argCount < 1) {
         runtimeError(vm, "'IO.print(value, ...)' takes at least one argument (%d provided)",
                      argCount);
-        return INTERPRET_RUNTIME_ERROR;
+        return BAD_VAL;
     }
     for (int i = 0; i < argCount; i++) {
         printValue(stdout, args[i]);
@@ -22,7 +22,7 @@ static Value printlnMethod(VM* vm, int argCount, Value* args) {
     if (argCount < 1) {
         runtimeError(vm, "'IO.println(value, ...)' takes at least one argument (%d provided)",
                      argCount);
-        return INTERPRET_RUNTIME_ERROR;
+        return BAD_VAL;
     }
     for (int i = 0; i < argCount; i++) {
         printValue(stdout, args[i]);
@@ -80,9 +80,9 @@ ObjModule* initLib_IO(VM* vm) {
     push(vm, OBJ_VAL(name));
     ObjModule* ioLib = newModule(vm, name);
     push(vm, OBJ_VAL(ioLib));
-    defineNative(vm, &ioLib->values, "print", printMethod);
-    defineNative(vm, &ioLib->values, "println", printlnMethod);
-    defineNative(vm, &ioLib->values, "input", inputMethod);
+    defineNative(vm, &ioLib->values, "print", ARITY_ANY, printMethod);
+    defineNative(vm, &ioLib->values, "println", ARITY_ANY, printlnMethod);
+    defineNative(vm, &ioLib->values, "input", ARITY_ANY, inputMethod);
     pop(vm);
     pop(vm);
     return ioLib;
@@ -3,121 +3,71 @@
 #include <math.h>
 
 
-static Value sineMath(VM* vm, int argCount, Value* args) {
-    if (argCount != 1) {
-        runtimeError(vm, "'Math.sin(arg)' takes exactly least one argument (%d provided)",
-                     argCount);
-        return BAD_VAL;
-    }
-    return NUMBER_VAL(sin(AS_NUMBER((double)args[0])));
+static double sineMath(double* args) {
+    return sin(args[0]);
 }
 
-static Value cosineMath(VM* vm, int argCount, Value* args) {
-    if (argCount != 1) {
-        runtimeError(vm, "'Math.cos(arg)' takes exactly least one argument (%d provided)",
-                     argCount);
-        return BAD_VAL;
-    }
-    return NUMBER_VAL(cos(AS_NUMBER((double)args[0])));
+static double cosineMath(double* args) {
+    return cos(args[0]);
 }
 
-static Value tangentMath(VM* vm, int argCount, Value* args) {
-    if (argCount != 1) {
-        runtimeError(vm, "'Math.tan(arg)' takes exactly least one argument (%d provided)",
-                     argCount);
-        return BAD_VAL;
-    }
-    return NUMBER_VAL(tan(AS_NUMBER((double)args[0])));
+static double tangentMath(double* args) {
+    return tan(args[0]);
 }
 
-static Value arcsinMath(VM* vm, int argCount, Value* args) {
-    if (argCount != 1) {
-        runtimeError(vm, "'Math.asin(arg)' takes exactly least one argument (%d provided)",
-                     argCount);
-        return BAD_VAL;
-    }
-    return NUMBER_VAL(asin(AS_NUMBER((double)args[0])));
+static double arcsinMath(double* args) {
+    return asin(args[0]);
 }
 
-static Value arccosMath(VM* vm, int argCount, Value* args) {
-    if (argCount != 1) {
-        runtimeError(vm, "'Math.acos(arg)' takes exactly least one argument (%d provided)",
-                     argCount);
-        return BAD_VAL;
-    }
-    return NUMBER_VAL(acos(AS_NUMBER((double)args[0])));
+static double arccosMath(double* args) {
+    return acos(args[0]);
 }
 
-static Value arctanMath(VM* vm, int argCount, Value* args) {
-    if (argCount != 1) {
-        runtimeError(vm, "'Math.atan(arg)' takes exactly least one argument (%d provided)",
-                     argCount);
-        return BAD_VAL;
-    }
-    return NUMBER_VAL(atan(AS_NUMBER((double)args[0])));
+static double arctanMath(double* args) {
+    return atan(args[0]);
 }
 
-static Value floorMath(VM* vm, int argCount, Value* args) {
-    if (argCount != 1) {
-        runtimeError(vm, "'Math.floor(arg)' takes exactly least one argument (%d provided)",
-                     argCount);
-        return BAD_VAL;
-    }
-    return NUMBER_VAL(floor(AS_NUMBER((double)args[0])));
+static double floorMath(double* args) {
+    return floor(args[0]);
 }
 
-static Value ceilMath(VM* vm, int argCount, Value* args) {
-    if (argCount != 1) {
-        runtimeError(vm, "'Math.ceil(arg)' takes exactly least one argument (%d provided)",
-                     argCount);
-        return BAD_VAL;
-    }
-    return NUMBER_VAL(ceil(AS_NUMBER((double)args[0])));
+static double ceilMath(double* args) {
+    return ceil(args[0]);
 }
 
-static Value logEMath(VM* vm, int argCount, Value* args) {
-    if (argCount != 1) {
-        runtimeError(vm, "'Math.ln(arg)' takes exactly least one argument (%d provided)",
-                     argCount);
-        return BAD_VAL;
-    }
-    return NUMBER_VAL(log(AS_NUMBER((double)args[0])));
+static double logEMath(double* args) {
+    return log(args[0]);
 }
 
-static Value log10Math(VM* vm, int argCount, Value* args) {
-    if (argCount != 1) {
-        runtimeError(vm, "'Math.log(arg)' takes exactly least one argument (%d provided)",
-                     argCount);
-        return BAD_VAL;
-    }
-    return NUMBER_VAL(log10(AS_NUMBER((double)args[0])));
+static double log10Math(double* args) {
+    return log10(args[0]);
 }
 
-static Value sqrtMath(VM* vm, int argCount, Value* args) {
-    if (argCount != 1) {
-        runtimeError(vm, "'Math.sqrt(arg)' takes exactly least one argument (%d provided)",
-                     argCount);
-        return BAD_VAL;
-    }
-    return NUMBER_VAL(sqrt(AS_NUMBER((double)args[0])));
+static double sqrtMath(double* args) {
+    return sqrt(args[0]);
+}
+
+static double powMath(double* args) {
+    return pow(args[0], args[1]);
 }
 
 ObjModule* initLib_Math(VM* vm) {
-    ObjString* name = copyString(vm, "Error", 5);
+    ObjString* name = copyString(vm, "Math", 4);
     push(vm, OBJ_VAL(name));
     ObjModule* mathLib = newModule(vm, name);
     push(vm, OBJ_VAL(mathLib));
-    defineNative(vm, &mathLib->values, "sin", sineMath);
-    defineNative(vm, &mathLib->values, "cos", cosineMath);
-    defineNative(vm, &mathLib->values, "tan", tangentMath);
-    defineNative(vm, &mathLib->values, "asin", arcsinMath);
-    defineNative(vm, &mathLib->values, "acos", arccosMath);
-    defineNative(vm, &mathLib->values, "atan", arctanMath);
-    defineNative(vm, &mathLib->values, "ceil", ceilMath);
-    defineNative(vm, &mathLib->values, "floor", floorMath);
-    defineNative(vm, &mathLib->values, "ln", logEMath);
-    defineNative(vm, &mathLib->values, "log", log10Math);
-    defineNative(vm, &mathLib->values, "sqrt", sqrtMath);
+    defineNumericNative(vm, &mathLib->values, "sin", 1, sineMath);
+    defineNumericNative(vm, &mathLib->values, "cos", 1, cosineMath);
+    defineNumericNative(vm, &mathLib->values, "tan", 1, tangentMath);
+    defineNumericNative(vm, &mathLib->values, "asin", 1, arcsinMath);
+    defineNumericNative(vm, &mathLib->values, "acos", 1, arccosMath);
+    defineNumericNative(vm, &mathLib->values, "atan", 1, arctanMath);
+    defineNumericNative(vm, &mathLib->values, "ceil", 1, ceilMath);
+    defineNumericNative(vm, &mathLib->values, "floor", 1, floorMath);
+    defineNumericNative(vm, &mathLib->values, "ln", 1, logEMath);
+    defineNumericNative(vm, &mathLib->values, "log", 1, log10Math);
+    defineNumericNative(vm, &mathLib->values, "sqrt", 1, sqrtMath);
+    defineNumericNative(vm, &mathLib->values, "pow", 2, powMath);
     pop(vm);
     pop(vm);
     return mathLib;
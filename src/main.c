@@ -59,8 +59,12 @@ int main(int argc, char* argv[]) {
         } else {
             runFile(vm, argv[1]);
         }
+    } else if (argc==3 && !strcmp(argv[1], "--stack")) {
+        // plain stack bytecode, for comparing against the register ops
+        vm->registerOps = false;
+        runFile(vm, argv[2]);
     } else {
-        fprintf(stderr, "Usage: ./simscript [path]\n");
+        fprintf(stderr, "Usage: ./simscript [--stack] [path]\n");
         exit(64);
     }
 
@@ -17,7 +17,7 @@ void* reallocate(VM* vm, void* pointer, size_t oldSize, size_t newSize) {
     // calling reallocate for more memory runs a garbage collection
     if (newSize > oldSize) {
 #ifdef DEBUG_STRESS_GC
-        collectGarbage();
+        collectGarbage(vm);
 #endif
         // collect according to a threshold value
         if (vm->bytesAllocated > vm->nextGC) {
@@ -95,6 +95,12 @@ static void blackenObject(VM* vm, Obj* object) {
             markArray(vm, &list->items);
             break;
         }
+        case OBJ_MAP:
+            markValueTable(vm, &((ObjMap*)object)->table);
+            break;
+        case OBJ_SET:
+            markValueTable(vm, &((ObjSet*)object)->table);
+            break;
         case OBJ_BOUND_METHOD: {
             ObjBoundMethod* bound = (ObjBoundMethod*)object;
             markValue(vm, bound->receiver);
@@ -120,6 +126,10 @@ static void blackenObject(VM* vm, Obj* object) {
             ObjFunction* function = (ObjFunction*)object;
             markObject(vm, (Obj*)function->name);
             markArray(vm, &function->chunk.constants);
+            for (int i = 0; i < function->chunk.cacheCount; i++) {
+                markObject(vm, function->chunk.caches[i].klass);
+                markObject(vm, function->chunk.caches[i].method);
+            }
             break;
         }
         case OBJ_INSTANCE: {
@@ -132,6 +142,10 @@ static void blackenObject(VM* vm, Obj* object) {
             markValue(vm, ((ObjUpvalue*)object)->closed);
             break;
         case OBJ_NATIVE:
+            markObject(vm, (Obj*)((ObjNative*)object)->name);
+            break;
+        case OBJ_ARRAY:
+        case OBJ_RANGE:
         case OBJ_STRING:
             break;
     }
@@ -155,10 +169,31 @@ static void freeObject(VM* vm, Obj* object) {
         }
         case OBJ_LIST: {
             ObjList* list = (ObjList*)object;
-            freeValueArray(vm, &list->items);
+            freeListItems(vm, list);
             FREE(vm, ObjList, object);
             break;
         }
+        case OBJ_ARRAY: {
+            ObjArray* array = (ObjArray*)object;
+            FREE_ARRAY(vm, double, array->values, array->count);
+            FREE(vm, ObjArray, object);
+            break;
+        }
+        case OBJ_MAP: {
+            ObjMap* map = (ObjMap*)object;
+            freeValueTable(vm, &map->table);
+            FREE(vm, ObjMap, object);
+            break;
+        }
+        case OBJ_SET: {
+            ObjSet* set = (ObjSet*)object;
+            freeValueTable(vm, &set->table);
+            FREE(vm, ObjSet, object);
+            break;
+        }
+        case OBJ_RANGE:
+            FREE(vm, ObjRange, object);
+            break;
         case OBJ_BOUND_METHOD: {
             FREE(vm, ObjBoundMethod, object);
             break;
@@ -189,7 +224,7 @@ static void freeObject(VM* vm, Obj* object) {
             break;
         }
         case OBJ_NATIVE: {
-            FREE(vm, OBJ_NATIVE, object); // native obj don't hold extra memory
+            FREE(vm, ObjNative, object); // native obj don't hold extra memory
             break;
         }
         case OBJ_STRING: {
@@ -217,14 +252,17 @@ static void markRoots(VM* vm) {
     }
 
     // marking upvalues
-    for (ObjUpvalue* upvalue = vm->openUpvalues; upvalue != NULL;
-            upvalue = upvalue->next) {
-        markObject(vm, (Obj*)upvalue);
+    for (int i = 0; i < vm->openTop; i++) {
+        markObject(vm, (Obj*)vm->openUpvalues[i]);
     }
 
     markTable(vm, &vm->globals);
     markTable(vm, &vm->modules);
     markTable(vm, &vm->listMethods);
+    markTable(vm, &vm->arrayMethods);
+    markTable(vm, &vm->mapMethods);
+    markTable(vm, &vm->setMethods);
+    markTable(vm, &vm->rangeMethods);
     markTable(vm, &vm->stringMethods);
     markCompilerRoots(vm);
     markObject(vm, (Obj*)vm->initString);
@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <unistd.h>
 
@@ -35,15 +36,12 @@ static Value clockNative(VM* vm, int argCount, Value* args ) {
  * @return Value Null val.
  */
 static Value sleepNative(VM* vm, int argCount, Value* args) {
-    if (argCount > 1) {
-        runtimeError(vm, "Too many arguments provided : %d", argCount);
-        return BAD_VAL;
-    }
+    UNUSED(argCount);
     if (!IS_NUMBER(args[0])) {
         runtimeError(vm, "Incorrect argument type.");
         return BAD_VAL;
     }
-    int waitFor = (int)AS_NUMBER(args[0]);
+    int waitFor = AS_INTEGER(args[0]);
 
     /* clock_t timeStart = clock();
     while (clock() < timeStart + waitFor)
@@ -64,15 +62,12 @@ static Value sleepNative(VM* vm, int argCount, Value* args) {
  * @return Value No return value
  */
 static Value exitNative(VM* vm, int argCount, Value* args) {
-    if (argCount > 1) {
-        runtimeError(vm, "Too many arguments provided : %d", argCount);
-        return BAD_VAL;
-    }
+    UNUSED(argCount);
     if (!IS_NUMBER(args[0])) {
         runtimeError(vm, "Incorrect argument type.");
         return BAD_VAL;
     }
-    int exitCode = (int)AS_NUMBER(args[0]);
+    int exitCode = AS_INTEGER(args[0]);
     printf("Program exit with exitcode %d\n", exitCode);
     exit(exitCode);
     return NULL_VAL;
@@ -86,10 +81,7 @@ static Value exitNative(VM* vm, int argCount, Value* args) {
  * @return Value NULL_VAL
  */
 static Value putsNative(VM* vm, int argCount, Value* args) {
-    if (argCount > 1) {
-        runtimeError(vm, "Too many arguments provided : %d", argCount);
-        return BAD_VAL;
-    }
+    UNUSED(argCount);
     if (!IS_STRING(args[0])) {
         runtimeError(vm, "Incorrect argument type.");
         return BAD_VAL;
@@ -106,10 +98,7 @@ static Value putsNative(VM* vm, int argCount, Value* args) {
  * @return Value NULL_VAL
  */
 static Value systemNative(VM* vm, int argCount, Value* args) {
-    if (argCount > 1) {
-        runtimeError(vm, "Too many arguments provided : %d", argCount);
-        return BAD_VAL;
-    }
+    UNUSED(argCount);
     if (!IS_STRING(args[0])) {
         runtimeError(vm, "Incorrect argument type.");
         return BAD_VAL;
@@ -118,25 +107,42 @@ static Value systemNative(VM* vm, int argCount, Value* args) {
     return NULL_VAL;
 }
 
-void defineNative(VM* vm, Table* table, const char* name, NativeFn function) {
-//    push( vm, OBJ_VAL(copyString(vm, name, (int)strlen(name))) );
-//    push( vm, OBJ_VAL(newNative(vm, function)) );
-//    tableSet(vm, table, AS_STRING(vm->stack[0]), OBJ_VAL(vm->stack[1]));
-    ObjNative* native = newNative(vm, function);
-    push(vm, OBJ_VAL(native));
+/**
+ * @brief Method to create a native and store it under its name
+ *
+ * @return ObjNative* The native, without a function set yet
+ */
+static ObjNative* addNative(VM* vm, Table* table, const char* name, int arity) {
     ObjString* fname = copyString(vm, name, (int)strlen(name));
     push(vm, OBJ_VAL(fname));
+    ObjNative* native = newNative(vm, fname, arity);
+    push(vm, OBJ_VAL(native));
     tableSet(vm, table, fname, OBJ_VAL(native));
     pop(vm);
     pop(vm);
+    return native;
+}
+
+void defineNative(VM* vm, Table* table, const char* name, int arity,
+                  NativeFn function) {
+    addNative(vm, table, name, arity)->function = function;
+}
+
+void defineNumericNative(VM* vm, Table* table, const char* name, int arity,
+                         NumericFn function) {
+    if (arity > NUMERIC_ARGS_MAX) {
+        fprintf(stderr, "Numeric native '%s' takes too many arguments.\n", name);
+        exit(1);
+    }
+    addNative(vm, table, name, arity)->numeric = function;
 }
 
 void defineNatives(VM* vm) {
     // defining native functions
-    defineNative(vm, &vm->globals, "clock", clockNative);
-    defineNative(vm, &vm->globals, "sleep", sleepNative);
-    defineNative(vm, &vm->globals, "puts", putsNative);
-    defineNative(vm, &vm->globals, "exit", exitNative);
-    defineNative(vm, &vm->globals, "system", systemNative);
+    defineNative(vm, &vm->globals, "clock", 0, clockNative);
+    defineNative(vm, &vm->globals, "sleep", 1, sleepNative);
+    defineNative(vm, &vm->globals, "puts", 1, putsNative);
+    defineNative(vm, &vm->globals, "exit", 1, exitNative);
+    defineNative(vm, &vm->globals, "system", 1, systemNative);
 }
 
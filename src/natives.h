@@ -9,9 +9,22 @@
  * function and the name it will be known in the language implementation
  *
  * @param name Name of native function
+ * @param arity Number of arguments the VM checks for, or ARITY_ANY
  * @param function Pointer to C function
  */
-void defineNative(VM* vm, Table* table, const char* name, NativeFn function);
+void defineNative(VM* vm, Table* table, const char* name, int arity,
+                  NativeFn function);
+
+/**
+ * @brief Method to define a native function over numbers. The VM checks
+ * that every argument is a number and passes them in unboxed.
+ *
+ * @param name Name of native function
+ * @param arity Number of arguments, at most NUMERIC_ARGS_MAX
+ * @param function Pointer to C function
+ */
+void defineNumericNative(VM* vm, Table* table, const char* name, int arity,
+                         NumericFn function);
 
 /**
  * @brief Function to define all the native functions
@@ -1,3 +1,4 @@
+#include <math.h>
 #include <string.h>
 
 #include "memory.h"
@@ -61,11 +62,175 @@ ObjModule* newModule(VM* vm, ObjString* name) {
 ObjList* newList(VM* vm) {
     ObjList* list = ALLOCATE_OBJ(vm, ObjList, OBJ_LIST);
     initValueArray(&list->items);
+    list->head = 0;
     return list;
 }
 
+ObjArray* newArray(VM* vm, int count) {
+    // the doubles are not traced, so they can be allocated first
+    double* values = ALLOCATE(vm, double, count);
+    if (count > 0) memset(values, 0, sizeof(double) * count);
+    ObjArray* array = ALLOCATE_OBJ(vm, ObjArray, OBJ_ARRAY);
+    array->count = count;
+    array->values = values;
+    return array;
+}
+
+ObjMap* newMap(VM* vm) {
+    ObjMap* map = ALLOCATE_OBJ(vm, ObjMap, OBJ_MAP);
+    initValueTable(&map->table);
+    return map;
+}
+
+ObjSet* newSet(VM* vm) {
+    ObjSet* set = ALLOCATE_OBJ(vm, ObjSet, OBJ_SET);
+    initValueTable(&set->table);
+    return set;
+}
+
+ObjRange* newRange(VM* vm, double start, double end, double step, int count) {
+    ObjRange* range = ALLOCATE_OBJ(vm, ObjRange, OBJ_RANGE);
+    range->start = start;
+    range->end = end;
+    range->step = step;
+    range->count = count;
+    range->integral = start >= INT32_MIN && start <= INT32_MAX &&
+                      step >= INT32_MIN && step <= INT32_MAX &&
+                      start == (int32_t)start && step == (int32_t)step;
+    return range;
+}
+
+/**
+ * @brief Method to move the items of a list to a new allocation with
+ * `front` free slots before them and `capacity` slots from the first on
+ *
+ */
+static void moveListItems(VM* vm, ObjList* list, int front, int capacity) {
+    int count = list->items.count;
+    Value* block = GROW_ARRAY(vm, Value, NULL, 0, front + capacity);
+    if (count > 0) {
+        memcpy(block + front, list->items.values, sizeof(Value) * count);
+    }
+    freeListItems(vm, list);
+    list->items.values = block + front;
+    list->items.count = count;
+    list->items.capacity = capacity;
+    list->head = front;
+}
+
+/**
+ * @brief Method to turn one slice bound into an index within [0, length]
+ *
+ */
+static int sliceBound(int length, Value bound, int fallback) {
+    if (IS_NULL(bound)) return fallback;
+    double index = AS_NUMBER(bound);
+    if (index < 0) index += length;
+    if (index < 0) return 0;
+    if (index > length) return length;
+    return (int)index;
+}
+
+/**
+ * @brief Method to check for a usable slice bound. NaN is left out since it
+ * cannot be clamped or converted to an index.
+ *
+ */
+static bool isSliceBound(Value bound) {
+    return IS_NULL(bound) || (IS_NUMBER(bound) && !isnan(AS_NUMBER(bound)));
+}
+
+bool sliceRange(int length, Value start, Value end, int* from, int* to) {
+    if (!isSliceBound(start) || !isSliceBound(end)) return false;
+    *from = sliceBound(length, start, 0);
+    *to = sliceBound(length, end, length);
+    if (*to < *from) *to = *from;
+    return true;
+}
+
+ObjList* sliceList(VM* vm, ObjList* list, int from, int to) {
+    ObjList* slice = newList(vm);
+    if (to > from) {
+        push(vm, OBJ_VAL(slice));
+        reserveList(vm, slice, to - from);
+        memcpy(slice->items.values, list->items.values + from,
+               sizeof(Value) * (to - from));
+        slice->items.count = to - from;
+        pop(vm);
+    }
+    return slice;
+}
+
+ObjArray* sliceArray(VM* vm, ObjArray* array, int from, int to) {
+    ObjArray* slice = newArray(vm, to - from);
+    if (to > from) {
+        memcpy(slice->values, array->values + from,
+               sizeof(double) * (to - from));
+    }
+    return slice;
+}
+
+void reserveList(VM* vm, ObjList* list, int capacity) {
+    ValueArray* items = &list->items;
+    if (items->capacity >= capacity) return;
+    Value* block = GROW_ARRAY(vm, Value,
+            items->values != NULL ? items->values - list->head : NULL,
+            (size_t)list->head + items->capacity,
+            (size_t)list->head + capacity);
+    items->values = block + list->head;
+    items->capacity = capacity;
+}
+
 void appendList(VM *vm, ObjList *list, Value value) {
-    writeValueArray(vm, &list->items, value);
+    ValueArray* items = &list->items;
+    if (items->capacity < items->count+1) {
+        reserveList(vm, list, GROW_CAPACITY(items->capacity));
+    }
+    items->values[items->count] = value;
+    items->count++;
+}
+
+void extendList(VM* vm, ObjList* list, ObjList* other) {
+    int count = other->items.count;
+    if (count == 0) return;
+    int needed = list->items.count + count;
+    if (list->items.capacity < needed) {
+        // still growing geometrically, for lists extended a bit at a time
+        int capacity = GROW_CAPACITY(list->items.capacity);
+        reserveList(vm, list, capacity > needed ? capacity : needed);
+    }
+    memcpy(list->items.values + list->items.count, other->items.values,
+           sizeof(Value) * count);
+    list->items.count = needed;
+}
+
+void prependList(VM* vm, ObjList* list, Value value) {
+    if (list->head == 0) {
+        int room = GROW_CAPACITY(list->items.count);
+        moveListItems(vm, list, room, room);
+    }
+    list->head--;
+    list->items.values--;
+    list->items.capacity++;
+    list->items.count++;
+    list->items.values[0] = value;
+}
+
+void insertList(VM* vm, ObjList* list, int index, Value value) {
+    if (index == 0) {
+        prependList(vm, list, value);
+        return;
+    }
+    if (index < list->items.count / 2) {
+        prependList(vm, list, list->items.values[0]);
+        memmove(list->items.values + 1, list->items.values + 2,
+                sizeof(Value) * (index - 1));
+    } else {
+        appendList(vm, list, NULL_VAL);
+        memmove(list->items.values + index + 1, list->items.values + index,
+                sizeof(Value) * (list->items.count - 1 - index));
+    }
+    list->items.values[index] = value;
 }
 
 bool validIndexList(VM *vm, ObjList *list, int index) {
@@ -95,19 +260,41 @@ void deleteFromIndexList(VM *vm, ObjList *list, int index) {
     UNUSED(vm);
     if (index<0)
         index += list->items.count;
-    for (int i = index; i < list->items.count-1; i++) {
-        list->items.values[i] = list->items.values[i+1];
+    if (index < list->items.count / 2) {
+        // closing the gap from the front
+        memmove(list->items.values + 1, list->items.values,
+                sizeof(Value) * index);
+        list->items.values++;
+        list->items.capacity--;
+        list->head++;
+    } else {
+        memmove(list->items.values + index, list->items.values + index + 1,
+                sizeof(Value) * (list->items.count - 1 - index));
     }
     list->items.count--;
+    if (list->items.count == 0) clearList(vm, list);
 }
 
 void clearList(VM* vm, ObjList* list) {
     UNUSED(vm);
-    for (int i = 0; i<list->items.count; i++) {
-        deleteFromIndexList(vm, list, i);
+    // an empty list gets all of its slots back at the end
+    list->items.count = 0;
+    if (list->items.values != NULL) {
+        list->items.values -= list->head;
+        list->items.capacity += list->head;
+        list->head = 0;
     }
 }
 
+void freeListItems(VM* vm, ObjList* list) {
+    if (list->items.values != NULL) {
+        FREE_ARRAY(vm, Value, list->items.values - list->head,
+                   list->head + list->items.capacity);
+    }
+    initValueArray(&list->items);
+    list->head = 0;
+}
+
 ObjBoundMethod* newBoundMethod(VM* vm, Value receiver, ObjClosure* method) {
     ObjBoundMethod* bound = ALLOCATE_OBJ(vm, ObjBoundMethod, OBJ_BOUND_METHOD);
     bound->receiver = receiver;
@@ -139,8 +326,11 @@ ObjFunction* newFunction(VM* vm, ObjModule* module, FunctionType type) {
     ObjFunction* function = ALLOCATE_OBJ(vm, ObjFunction, OBJ_FUNCTION);
     function->params = 0;
     function->upvalueCount = 0;
+    function->stackSize = 0;
     function->name = NULL;
     function->type = type;
+    function->accessor = ACCESSOR_NONE;
+    function->field = NULL;
     function->module = module;
     initChunk(vm, &function->chunk);
     return function;
@@ -153,9 +343,12 @@ ObjInstance* newInstance(VM* vm, ObjClass* klass) {
     return instance;
 }
 
-ObjNative* newNative(VM* vm, NativeFn function) {
+ObjNative* newNative(VM* vm, ObjString* name, int arity) {
     ObjNative* native = ALLOCATE_OBJ(vm, ObjNative, OBJ_NATIVE);
-    native->function = function;
+    native->function = NULL;
+    native->numeric = NULL;
+    native->name = name;
+    native->arity = arity;
     return native;
 }
 
@@ -227,7 +420,6 @@ ObjUpvalue* newUpvalue(VM* vm, Value* slot) {
     ObjUpvalue* upvalue = ALLOCATE_OBJ(vm, ObjUpvalue, OBJ_UPVALUE);
     upvalue->closed = NULL_VAL;
     upvalue->location = slot;
-    upvalue->next = NULL;
     return upvalue;
 }
 /**
@@ -258,6 +450,57 @@ void printObject(FILE* file, Value value) {
             fprintf(file, "]");
             break;
         }
+        case OBJ_ARRAY: {
+            ObjArray* array = AS_ARRAY(value);
+            fprintf(file, "Float64Array[");
+            for (int i=0; i<array->count; i++) {
+                printValue(file, NUMBER_VAL(array->values[i]));
+                if (i != array->count-1) fprintf(file, ", ");
+            }
+            fprintf(file, "]");
+            break;
+        }
+        case OBJ_MAP: {
+            ValueTable* table = &AS_MAP(value)->table;
+            fprintf(file, "{");
+            bool first = true;
+            for (int i=0; i<table->capacity; i++) {
+                ValueEntry* entry = &table->entries[i];
+                if (IS_NULL(entry->key)) continue;
+                if (!first) fprintf(file, ", ");
+                printValue(file, entry->key);
+                fprintf(file, ": ");
+                printValue(file, entry->value);
+                first = false;
+            }
+            fprintf(file, "}");
+            break;
+        }
+        case OBJ_SET: {
+            ValueTable* table = &AS_SET(value)->table;
+            fprintf(file, "Set{");
+            bool first = true;
+            for (int i=0; i<table->capacity; i++) {
+                ValueEntry* entry = &table->entries[i];
+                if (IS_NULL(entry->key)) continue;
+                if (!first) fprintf(file, ", ");
+                printValue(file, entry->key);
+                first = false;
+            }
+            fprintf(file, "}");
+            break;
+        }
+        case OBJ_RANGE: {
+            ObjRange* range = AS_RANGE(value);
+            fprintf(file, "range(");
+            printValue(file, NUMBER_VAL(range->start));
+            fprintf(file, ", ");
+            printValue(file, NUMBER_VAL(range->end));
+            fprintf(file, ", ");
+            printValue(file, NUMBER_VAL(range->step));
+            fprintf(file, ")");
+            break;
+        }
         case OBJ_BOUND_METHOD:
             printFunction(file, AS_BOUND_METHOD(value)->method->function);
             break;
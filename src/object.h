@@ -26,6 +26,30 @@
  */
 #define IS_LIST(value) isObjType(value, OBJ_LIST)
 
+/**
+ * @brief Macro to check if a value is of Float64Array type
+ *
+ */
+#define IS_ARRAY(value) isObjType(value, OBJ_ARRAY)
+
+/**
+ * @brief Macro to check if a value is of map type
+ *
+ */
+#define IS_MAP(value) isObjType(value, OBJ_MAP)
+
+/**
+ * @brief Macro to check if a value is of set type
+ *
+ */
+#define IS_SET(value) isObjType(value, OBJ_SET)
+
+/**
+ * @brief Macro to check if a value is of range type
+ *
+ */
+#define IS_RANGE(value) isObjType(value, OBJ_RANGE)
+
 /**
  * @brief Macro to check if a value is of bound-method type
  *
@@ -80,6 +104,30 @@
  */ 
 #define AS_LIST(value)   ( (ObjList*)AS_OBJ(value) )
 
+/**
+ * @brief Macro to convert into a Float64Array object
+ *
+ */ 
+#define AS_ARRAY(value)   ( (ObjArray*)AS_OBJ(value) )
+
+/**
+ * @brief Macro to convert into a map object
+ *
+ */
+#define AS_MAP(value)     ( (ObjMap*)AS_OBJ(value) )
+
+/**
+ * @brief Macro to convert into a set object
+ *
+ */
+#define AS_SET(value)     ( (ObjSet*)AS_OBJ(value) )
+
+/**
+ * @brief Macro to convert into a range object
+ *
+ */
+#define AS_RANGE(value)   ( (ObjRange*)AS_OBJ(value) )
+
 /**
  * @brief Macro to convert into a bound-method object
  *
@@ -110,8 +158,7 @@
  * @brief Macro to convert into a native function object
  *
  */
-#define AS_NATIVE(value) \
-    ( ((ObjNative*)AS_OBJ(value))->function )
+#define AS_NATIVE(value)       ( (ObjNative*)AS_OBJ(value) )
 
 /**
  * @brief Macro to convert into string implementation
@@ -132,6 +179,10 @@
 typedef enum {
     OBJ_MODULE,
     OBJ_LIST,
+    OBJ_ARRAY,
+    OBJ_MAP,
+    OBJ_SET,
+    OBJ_RANGE,
     OBJ_BOUND_METHOD,
     OBJ_CLASS,
     OBJ_CLOSURE,
@@ -164,6 +215,18 @@ typedef enum {
     TYPE_SCRIPT,
 } FunctionType;
 
+/**
+ * @brief Enum to mark methods simple enough for the VM to run at the call
+ * site without a call frame
+ *
+ */
+typedef enum {
+    ACCESSOR_NONE,
+    ACCESSOR_GET,      // return this.field;
+    ACCESSOR_SET,      // this.field = value;
+    ACCESSOR_SET_THIS, // this.field = value; return this;
+} AccessorKind;
+
 /**
  * @class ObjModule
  * @brief Defining modules
@@ -177,13 +240,59 @@ typedef struct {
 
 /**
  * @class ObjList
- * @brief Defining lists
+ * @brief Defining lists. The items start `head` slots into their allocation,
+ * so that values can be added and removed at the front without moving the
+ * rest. `items.capacity` counts the slots from the first item on.
  */
 typedef struct {
     Obj obj;
     ValueArray items;
+    int head;
 } ObjList;
 
+/**
+ * @class ObjArray
+ * @brief Defining Float64Arrays, fixed-length arrays of unboxed doubles
+ */
+typedef struct {
+    Obj obj;
+    int count;
+    double* values;
+} ObjArray;
+
+/**
+ * @class ObjMap
+ * @brief Defining maps, hash tables from any non-null key to a value
+ */
+typedef struct {
+    Obj obj;
+    ValueTable table;
+} ObjMap;
+
+/**
+ * @class ObjSet
+ * @brief Defining sets, hash tables of keys whose values are all true
+ */
+typedef struct {
+    Obj obj;
+    ValueTable table;
+} ObjSet;
+
+/**
+ * @class ObjRange
+ * @brief Defining ranges, arithmetic sequences of numbers that are worked
+ * out one at a time instead of being stored. `integral` is set when the
+ * start and step are whole numbers, so that the values can be ints.
+ */
+typedef struct {
+    Obj obj;
+    double start;
+    double end;
+    double step;
+    int count;
+    bool integral;
+} ObjRange;
+
 /**
  * @class ObjFunction
  * @brief Defining functions as first class.
@@ -192,12 +301,15 @@ typedef struct {
     Obj obj;
     int params;
     int upvalueCount;
+    int stackSize; // deepest the stack gets in a call, from the frame base
     Chunk chunk;
     ObjString* name;
 
     ObjModule* module;
 
     FunctionType type;
+    AccessorKind accessor;
+    ObjString* field; // field read or written by an accessor
 } ObjFunction;
 
 /**
@@ -207,13 +319,28 @@ typedef struct {
  */
 typedef Value (*NativeFn)(VM* vm, int argCount, Value* args);
 
+/**
+ * @brief Declare NumericFn as a function pointer for natives that take their
+ * arguments as unboxed doubles and return a double
+ *
+ */
+typedef double (*NumericFn)(double* args);
+
+#define ARITY_ANY        -1 // natives that check their own argument count
+#define NUMERIC_ARGS_MAX 4
+
 /**
  * @class ObjNative
- * @brief Struct to define native functions
+ * @brief Struct to define native functions. The argument count is checked
+ * by the VM before the call, and numeric natives set `numeric` instead of
+ * `function`.
  */
 typedef struct {
     Obj obj;
     NativeFn function;
+    NumericFn numeric;
+    ObjString* name;
+    int arity;
 } ObjNative;
 
 /**
@@ -237,7 +364,6 @@ typedef struct ObjUpvalue {
     Obj obj;
     Value* location;
     Value closed;
-    struct ObjUpvalue* next;
 } ObjUpvalue;
 
 /**
@@ -302,6 +428,44 @@ ObjModule* newModule(VM* vm, ObjString* name);
  */
 ObjList* newList(VM* vm);
 
+/**
+ * @brief Method to create a new Float64Array filled with zeros
+ *
+ * @param vm 
+ * @param count Number of elements
+ * @return ObjArray* Pointer to new array
+ */
+ObjArray* newArray(VM* vm, int count);
+
+/**
+ * @brief Method to create a new empty map
+ *
+ * @param vm 
+ * @return ObjMap* Pointer to new map
+ */
+ObjMap* newMap(VM* vm);
+
+/**
+ * @brief Method to create a new empty set
+ *
+ * @param vm 
+ * @return ObjSet* Pointer to new set
+ */
+ObjSet* newSet(VM* vm);
+
+/**
+ * @brief Method to create a new range from `start` up to, but not
+ * including, `end`
+ *
+ * @param vm 
+ * @param start First value
+ * @param end Bound on the values
+ * @param step Nonzero difference between consecutive values
+ * @param count Number of values in the range
+ * @return ObjRange* Pointer to new range
+ */
+ObjRange* newRange(VM* vm, double start, double end, double step, int count);
+
 /**
  * @brief Method to append a value to a list
  *
@@ -311,6 +475,83 @@ ObjList* newList(VM* vm);
  */
 void appendList(VM* vm, ObjList* list, Value value);
 
+/**
+ * @brief Method to turn slice bounds into a range of indices. Negative
+ * bounds count from the end, bounds past either end are clamped to it, and
+ * null bounds stand for the ends themselves.
+ *
+ * @param length Length of the sliced sequence
+ * @param start First bound, a number or null
+ * @param end Second bound, a number or null
+ * @param from Set to the first index of the slice
+ * @param to Set to one past the last index of the slice, at least `from`
+ * @return bool False if a bound is NaN or neither a number nor null
+ */
+bool sliceRange(int length, Value start, Value end, int* from, int* to);
+
+/**
+ * @brief Method to copy the items from `from` up to `to` into a new list
+ *
+ * @param vm 
+ * @param list 
+ * @param from 
+ * @param to 
+ * @return ObjList* Pointer to new list
+ */
+ObjList* sliceList(VM* vm, ObjList* list, int from, int to);
+
+/**
+ * @brief Method to copy the elements from `from` up to `to` into a new
+ * Float64Array
+ *
+ * @param vm 
+ * @param array 
+ * @param from 
+ * @param to 
+ * @return ObjArray* Pointer to new array
+ */
+ObjArray* sliceArray(VM* vm, ObjArray* array, int from, int to);
+
+/**
+ * @brief Method to make room for at least `capacity` items in a list, so
+ * that appending up to that many does not reallocate
+ *
+ * @param vm 
+ * @param list 
+ * @param capacity 
+ */
+void reserveList(VM* vm, ObjList* list, int capacity);
+
+/**
+ * @brief Method to append all items of `other` to a list with one copy.
+ * `other` may be the list itself.
+ *
+ * @param vm 
+ * @param list 
+ * @param other 
+ */
+void extendList(VM* vm, ObjList* list, ObjList* other);
+
+/**
+ * @brief Method to add a value to the front of a list. Amortized O(1)
+ *
+ * @param vm 
+ * @param list 
+ * @param value 
+ */
+void prependList(VM* vm, ObjList* list, Value value);
+
+/**
+ * @brief Method to insert a value before the given index, moving whichever
+ * side of the list is shorter
+ *
+ * @param vm 
+ * @param list 
+ * @param index Index of the new value, from 0 to the list length
+ * @param value 
+ */
+void insertList(VM* vm, ObjList* list, int index, Value value);
+
 /**
  * @brief Method to check if an index is a valid index for a list
  *
@@ -342,7 +583,8 @@ Value getFromIndexList(VM* vm, ObjList* list, int index);
 void setToIndexList(VM* vm, ObjList* list, int index, Value value);
 
 /**
- * @brief Method to delete a value from a list at given index
+ * @brief Method to delete a value from a list at given index, moving
+ * whichever side of the list is shorter
  *
  * @param vm 
  * @param list 
@@ -358,6 +600,14 @@ void deleteFromIndexList(VM* vm, ObjList* list, int index);
  */
 void clearList(VM* vm, ObjList* list);
 
+/**
+ * @brief Method to free the items of a list
+ *
+ * @param vm 
+ * @param list 
+ */
+void freeListItems(VM* vm, ObjList* list);
+
 /**
  * @brief Method to create a new bound method
  *
@@ -400,12 +650,14 @@ ObjFunction* newFunction(VM* vm, ObjModule* module, FunctionType type);
 ObjInstance* newInstance(VM* vm, ObjClass* klass);
 
 /**
- * @brief Method to create a new native function
+ * @brief Method to create a new native function. The caller sets either
+ * the `function` or the `numeric` pointer.
  *
- * @param function A pointer to a native function
+ * @param name Name of the native function
+ * @param arity Number of arguments taken, or ARITY_ANY
  * @return ObjNative* A pointer to the native function created
  */
-ObjNative* newNative(VM* vm, NativeFn function);
+ObjNative* newNative(VM* vm, ObjString* name, int arity);
 
 /**
  * @brief Method to create an ObjString given a C-string. Assumes ownership
@@ -457,4 +709,19 @@ static inline ObjType getObjType(Value value) {
     return AS_OBJ(value)->type;
 }
 
+/**
+ * @brief Method to get the value at an index of a range
+ *
+ * @param range The range
+ * @param index Index less than the range count
+ * @return Value The value, an int if the range is integral
+ */
+static inline Value rangeValue(ObjRange* range, int index) {
+    if (range->integral) {
+        return intToValue((int64_t)range->start +
+                          (int64_t)index * (int64_t)range->step);
+    }
+    return NUMBER_VAL(range->start + index * range->step);
+}
+
 #endif
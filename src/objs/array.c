@@ -0,0 +1,388 @@
+#include "array.h"
+#include "../natives.h"
+
+/*
+ * The bulk methods below are written as plain loops over `restrict` pointers
+ * so that the C compiler can turn them into SIMD instructions (the release
+ * build compiles with RELEASE_CFLAGS). Reductions keep four running partial
+ * results, which lets them be vectorized without floating point
+ * reassociation flags and breaks up the add latency chain.
+ *
+ * min() and max() are the exception: compilers do not vectorize a
+ * compare-and-select reduction without fast-math flags, so they use SSE2 or
+ * AVX vectors directly with the plain loop as the fallback, like the scanner.
+ * maxpd/minpd return their second operand unless the first one compares
+ * greater (smaller), which is exactly `a[i] > m ? a[i] : m`, so both paths
+ * agree on NaNs and signed zeros.
+ */
+#if defined(__AVX__)
+#include <immintrin.h>
+#define LANES 4
+typedef __m256d Lanes;
+#define LANES_LOAD(p)     _mm256_loadu_pd(p)
+#define LANES_STORE(p, v) _mm256_storeu_pd((p), (v))
+#define LANES_SPLAT(x)    _mm256_set1_pd(x)
+#define LANES_MIN(a, b)   _mm256_min_pd((a), (b))
+#define LANES_MAX(a, b)   _mm256_max_pd((a), (b))
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define LANES 2
+typedef __m128d Lanes;
+#define LANES_LOAD(p)     _mm_loadu_pd(p)
+#define LANES_STORE(p, v) _mm_storeu_pd((p), (v))
+#define LANES_SPLAT(x)    _mm_set1_pd(x)
+#define LANES_MIN(a, b)   _mm_min_pd((a), (b))
+#define LANES_MAX(a, b)   _mm_max_pd((a), (b))
+#endif
+
+/**
+ * @brief Method to check that a method argument is a Float64Array of the
+ * same length as the receiver
+ *
+ * @param vm
+ * @param array The receiver
+ * @param arg The argument to check
+ * @param method Name of the method, for the error message
+ * @return ObjArray* The argument array, or NULL after a runtime error
+ */
+static ObjArray* matchingArray(VM* vm, ObjArray* array, Value arg,
+                               const char* method) {
+    if (!IS_ARRAY(arg)) {
+        runtimeError(vm, "Argument to '%s()' must be a Float64Array.", method);
+        return NULL;
+    }
+    ObjArray* other = AS_ARRAY(arg);
+    if (other->count != array->count) {
+        runtimeError(vm, "Float64Array lengths do not match in '%s()' (%d and %d).",
+                     method, array->count, other->count);
+        return NULL;
+    }
+    return other;
+}
+
+/**
+ * @brief Creating a Float64Array from a length or from a list of numbers.
+ *
+ * @param vm
+ * @param argCount
+ * @param args
+ * @return
+ */
+static Value float64ArrayNative(VM* vm, int argCount, Value* args) {
+    UNUSED(argCount);
+    if (IS_NUMBER(args[0])) {
+        if (!(AS_NUMBER(args[0]) >= 0) || AS_NUMBER(args[0]) > INT32_MAX) {
+            runtimeError(vm, "Float64Array length must be a number from 0 to %d.",
+                         INT32_MAX);
+            return BAD_VAL;
+        }
+        return OBJ_VAL(newArray(vm, AS_INTEGER(args[0])));
+    }
+    if (!IS_LIST(args[0])) {
+        runtimeError(vm, "Float64Array() takes a length or a list of numbers.");
+        return BAD_VAL;
+    }
+    ObjList* list = AS_LIST(args[0]);
+    for (int i = 0; i < list->items.count; i++) {
+        if (!IS_NUMBER(list->items.values[i])) {
+            runtimeError(vm, "Float64Array values must be numbers (index %d).", i);
+            return BAD_VAL;
+        }
+    }
+    ObjArray* array = newArray(vm, list->items.count);
+    for (int i = 0; i < list->items.count; i++) {
+        array->values[i] = AS_NUMBER(list->items.values[i]);
+    }
+    return OBJ_VAL(array);
+}
+
+static Value lengthMethod(VM* vm, int argCount, Value* args) {
+    UNUSED(vm);
+    UNUSED(argCount);
+    return INT_VAL(AS_ARRAY(args[0])->count);
+}
+
+/**
+ * @brief Elementwise sum of two arrays, as a new array. O(n)
+ *
+ * @param vm
+ * @param argCount
+ * @param args
+ * @return
+ */
+static Value addMethod(VM* vm, int argCount, Value* args) {
+    UNUSED(argCount);
+    ObjArray* array = AS_ARRAY(args[0]);
+    ObjArray* other = matchingArray(vm, array, args[1], "add");
+    if (other == NULL) return BAD_VAL;
+
+    ObjArray* result = newArray(vm, array->count);
+    const double* restrict a = array->values;
+    const double* restrict b = other->values;
+    double* restrict out = result->values;
+    for (int i = 0; i < array->count; i++) {
+        out[i] = a[i] + b[i];
+    }
+    return OBJ_VAL(result);
+}
+
+/**
+ * @brief Elementwise product of two arrays, as a new array. O(n)
+ *
+ * @param vm
+ * @param argCount
+ * @param args
+ * @return
+ */
+static Value mulMethod(VM* vm, int argCount, Value* args) {
+    UNUSED(argCount);
+    ObjArray* array = AS_ARRAY(args[0]);
+    ObjArray* other = matchingArray(vm, array, args[1], "mul");
+    if (other == NULL) return BAD_VAL;
+
+    ObjArray* result = newArray(vm, array->count);
+    const double* restrict a = array->values;
+    const double* restrict b = other->values;
+    double* restrict out = result->values;
+    for (int i = 0; i < array->count; i++) {
+        out[i] = a[i] * b[i];
+    }
+    return OBJ_VAL(result);
+}
+
+/**
+ * @brief Every element multiplied by a number, as a new array. O(n)
+ *
+ * @param vm
+ * @param argCount
+ * @param args
+ * @return
+ */
+static Value scaleMethod(VM* vm, int argCount, Value* args) {
+    UNUSED(argCount);
+    if (!IS_NUMBER(args[1])) {
+        runtimeError(vm, "Argument to 'scale()' must be a number.");
+        return BAD_VAL;
+    }
+    ObjArray* array = AS_ARRAY(args[0]);
+    double factor = AS_NUMBER(args[1]);
+
+    ObjArray* result = newArray(vm, array->count);
+    const double* restrict a = array->values;
+    double* restrict out = result->values;
+    for (int i = 0; i < array->count; i++) {
+        out[i] = a[i] * factor;
+    }
+    return OBJ_VAL(result);
+}
+
+/**
+ * @brief Sum of all elements. O(n)
+ *
+ * @param vm
+ * @param argCount
+ * @param args
+ * @return
+ */
+static Value sumMethod(VM* vm, int argCount, Value* args) {
+    UNUSED(vm);
+    UNUSED(argCount);
+    ObjArray* array = AS_ARRAY(args[0]);
+    const double* a = array->values;
+    int count = array->count;
+
+    double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        s0 += a[i];
+        s1 += a[i+1];
+        s2 += a[i+2];
+        s3 += a[i+3];
+    }
+    for (; i < count; i++) s0 += a[i];
+    return NUMBER_VAL((s0 + s1) + (s2 + s3));
+}
+
+/**
+ * @brief Dot product with another array. O(n)
+ *
+ * @param vm
+ * @param argCount
+ * @param args
+ * @return
+ */
+static Value dotMethod(VM* vm, int argCount, Value* args) {
+    UNUSED(argCount);
+    ObjArray* array = AS_ARRAY(args[0]);
+    ObjArray* other = matchingArray(vm, array, args[1], "dot");
+    if (other == NULL) return BAD_VAL;
+    const double* restrict a = array->values;
+    const double* restrict b = other->values;
+    int count = array->count;
+
+    double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        s0 += a[i] * b[i];
+        s1 += a[i+1] * b[i+1];
+        s2 += a[i+2] * b[i+2];
+        s3 += a[i+3] * b[i+3];
+    }
+    for (; i < count; i++) s0 += a[i] * b[i];
+    return NUMBER_VAL((s0 + s1) + (s2 + s3));
+}
+
+/**
+ * @brief Smallest or largest element of a non-empty array. O(n)
+ *
+ * Keeps eight running partials (element i goes to partial i % 8) on both the
+ * vector and the plain path, so they pick the same element on ties.
+ *
+ * @param array
+ * @param largest True to find the largest element
+ * @return double
+ */
+static double extremum(ObjArray* array, bool largest) {
+    const double* a = array->values;
+    int count = array->count;
+    double m[8];
+    for (int j = 0; j < 8; j++) m[j] = a[0];
+    int i = 0;
+#ifdef LANES
+    Lanes acc[8 / LANES];
+    for (int g = 0; g < 8 / LANES; g++) acc[g] = LANES_SPLAT(a[0]);
+    if (largest) {
+        for (; i + 8 <= count; i += 8) {
+            for (int g = 0; g < 8 / LANES; g++) {
+                acc[g] = LANES_MAX(LANES_LOAD(a + i + g * LANES), acc[g]);
+            }
+        }
+    } else {
+        for (; i + 8 <= count; i += 8) {
+            for (int g = 0; g < 8 / LANES; g++) {
+                acc[g] = LANES_MIN(LANES_LOAD(a + i + g * LANES), acc[g]);
+            }
+        }
+    }
+    for (int g = 0; g < 8 / LANES; g++) LANES_STORE(m + g * LANES, acc[g]);
+#endif
+    for (; i + 8 <= count; i += 8) {
+        for (int j = 0; j < 8; j++) {
+            double x = a[i+j];
+            m[j] = (largest ? x > m[j] : x < m[j]) ? x : m[j];
+        }
+    }
+    for (; i < count; i++) {
+        m[0] = (largest ? a[i] > m[0] : a[i] < m[0]) ? a[i] : m[0];
+    }
+    for (int width = 4; width > 0; width /= 2) {
+        for (int j = 0; j < width; j++) {
+            double x = m[j + width];
+            m[j] = (largest ? x > m[j] : x < m[j]) ? x : m[j];
+        }
+    }
+    return m[0];
+}
+
+static Value minMethod(VM* vm, int argCount, Value* args) {
+    UNUSED(argCount);
+    ObjArray* array = AS_ARRAY(args[0]);
+    if (array->count == 0) {
+        runtimeError(vm, "Cannot take 'min()' of an empty Float64Array.");
+        return BAD_VAL;
+    }
+    return NUMBER_VAL(extremum(array, false));
+}
+
+static Value maxMethod(VM* vm, int argCount, Value* args) {
+    UNUSED(argCount);
+    ObjArray* array = AS_ARRAY(args[0]);
+    if (array->count == 0) {
+        runtimeError(vm, "Cannot take 'max()' of an empty Float64Array.");
+        return BAD_VAL;
+    }
+    return NUMBER_VAL(extremum(array, true));
+}
+
+/**
+ * @brief Running totals of the elements, as a new array. O(n)
+ *
+ * @param vm
+ * @param argCount
+ * @param args
+ * @return
+ */
+static Value cumsumMethod(VM* vm, int argCount, Value* args) {
+    UNUSED(argCount);
+    ObjArray* array = AS_ARRAY(args[0]);
+    ObjArray* result = newArray(vm, array->count);
+    const double* restrict a = array->values;
+    double* restrict out = result->values;
+    double total = 0;
+    for (int i = 0; i < array->count; i++) {
+        total += a[i];
+        out[i] = total;
+    }
+    return OBJ_VAL(result);
+}
+
+/**
+ * @brief Copying the elements from index `start` up to `end` into a new Float64Array.
+ * Without `end` the slice runs to the end. O(k) in the slice length
+ *
+ * @param vm 
+ * @param argCount 
+ * @param args 
+ * @return 
+ */
+static Value sliceMethod(VM* vm, int argCount, Value* args) {
+    if (argCount != 1 && argCount != 2) {
+        runtimeError(vm, "Function slice() expected 1 or 2 arguments but got %d.",
+                     argCount);
+        return BAD_VAL;
+    }
+    ObjArray* array = AS_ARRAY(args[0]);
+    int from, to;
+    if (!sliceRange(array->count, args[1], argCount == 2 ? args[2] : NULL_VAL,
+                    &from, &to)) {
+        runtimeError(vm, "Slice bounds must be numbers or null.");
+        return BAD_VAL;
+    }
+    return OBJ_VAL(sliceArray(vm, array, from, to));
+}
+
+/**
+ * @brief Copying the elements into a new list. O(n)
+ *
+ * @param vm
+ * @param argCount
+ * @param args
+ * @return
+ */
+static Value toListMethod(VM* vm, int argCount, Value* args) {
+    UNUSED(argCount);
+    ObjArray* array = AS_ARRAY(args[0]);
+    ObjList* list = newList(vm);
+    push(vm, OBJ_VAL(list));
+    for (int i = 0; i < array->count; i++) {
+        appendList(vm, list, NUMBER_VAL(array->values[i]));
+    }
+    pop(vm);
+    return OBJ_VAL(list);
+}
+
+void defineArrayMethods(VM* vm) {
+    defineNative(vm, &vm->globals, "Float64Array", 1, float64ArrayNative);
+
+    defineNative(vm, &vm->arrayMethods, "length", 0, lengthMethod);
+    defineNative(vm, &vm->arrayMethods, "add", 1, addMethod);
+    defineNative(vm, &vm->arrayMethods, "mul", 1, mulMethod);
+    defineNative(vm, &vm->arrayMethods, "scale", 1, scaleMethod);
+    defineNative(vm, &vm->arrayMethods, "sum", 0, sumMethod);
+    defineNative(vm, &vm->arrayMethods, "dot", 1, dotMethod);
+    defineNative(vm, &vm->arrayMethods, "min", 0, minMethod);
+    defineNative(vm, &vm->arrayMethods, "max", 0, maxMethod);
+    defineNative(vm, &vm->arrayMethods, "cumsum", 0, cumsumMethod);
+    defineNative(vm, &vm->arrayMethods, "toList", 0, toListMethod);
+    defineNative(vm, &vm->arrayMethods, "slice", ARITY_ANY, sliceMethod);
+}
@@ -0,0 +1,8 @@
+#ifndef simscript_array_h
+#define simscript_array_h
+
+#include "../vm.h"
+
+void defineArrayMethods(VM* vm);
+
+#endif
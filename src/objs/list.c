@@ -1,8 +1,10 @@
+#include <string.h>
+
 #include "list.h"
 #include "../natives.h"
 
 /**
- * @brief Adding an element to the end of the list. O(n)
+ * @brief Adding an element to the end of the list. Amortized O(1)
  *
  * @param vm 
  * @param argCount 
@@ -10,18 +12,14 @@
  * @return 
  */
 static Value appendMethod(VM* vm, int argCount, Value* args) {
-    if (argCount != 1) {
-        runtimeError(vm, "'append(value)' expects exactly one argument (%d provided).",
-                argCount);
-        return BAD_VAL;
-    }
+    UNUSED(argCount);
     ObjList* list = AS_LIST(args[0]);
     appendList(vm, list, args[1]);
     return NULL_VAL;
 }
 
 /**
- * @brief Adding an element at index 0. O(n)
+ * @brief Adding an element at index 0. Amortized O(1)
  *
  * @param vm 
  * @param argCount 
@@ -29,22 +27,15 @@ static Value appendMethod(VM* vm, int argCount, Value* args) {
  * @return 
  */
 static Value prependMethod(VM* vm, int argCount, Value* args) {
-    if (argCount != 1) {
-        runtimeError(vm, "'prepend(value)' expects exactly one argument (%d provided).",
-                argCount);
-        return BAD_VAL;
-    }
+    UNUSED(argCount);
     ObjList* list = AS_LIST(args[0]);
-    appendList(vm, list, NULL_VAL);
-    for (int i = list->items.count-1; i > 0; i--) {
-        list->items.values[i] = list->items.values[i-1];
-    }
-    list->items.values[0] = args[1];
+    prependList(vm, list, args[1]);
     return NULL_VAL;
 }
 
 /**
- * @brief Insert an element at a specified index. O(n)
+ * @brief Insert an element at a specified index. O(n) in the distance to the
+ * nearer end of the list
  *
  * @param vm 
  * @param argCount 
@@ -52,31 +43,25 @@ static Value prependMethod(VM* vm, int argCount, Value* args) {
  * @return 
  */
 static Value insertMethod(VM* vm, int argCount, Value* args) {
-    if (argCount != 2) {
-        runtimeError(vm, "'insert(index, value)' expects two arguments (%d provided).",
-                argCount);
-        return BAD_VAL;
-    }
+    UNUSED(argCount);
     if (!IS_NUMBER(args[1])){
         runtimeError(vm, "Wrong argument type for arg 'index' in method 'insert(index, value)'.");
+        return BAD_VAL;
     }
     ObjList* list = AS_LIST(args[0]);
-    int index = AS_NUMBER(args[1]);
-    if (index > list->items.count) {
+    int index = AS_INTEGER(args[1]);
+    if (index < 0 || index > list->items.count) {
         runtimeError(vm, "List index out of bounds (given %d, length %d).",
-                index, list->items.count-1);
+                index, list->items.count);
         return BAD_VAL;
     }
-    appendList(vm, list, NULL_VAL);
-    for (int i = list->items.count-1; i >= index; i--) {
-        list->items.values[i] = list->items.values[i-1];
-    }
-    list->items.values[index] = args[2];
+    insertList(vm, list, index, args[2]);
     return NULL_VAL;
 }
 
 /**
- * @brief Deleting an element at a specified index.
+ * @brief Deleting an element at a specified index. O(n) in the distance to
+ * the nearer end of the list
  *
  * @param vm 
  * @param argCount 
@@ -84,29 +69,37 @@ static Value insertMethod(VM* vm, int argCount, Value* args) {
  * @return 
  */
 static Value deleteMethod(VM* vm, int argCount, Value* args) {
-    if (argCount != 1) {
-        runtimeError(vm, "'delete(index)' expects exactly one argument (%d provided).",
-                argCount);
+    UNUSED(argCount);
+    if (!IS_NUMBER(args[1])){
+        runtimeError(vm, "Wrong argument type for arg 'index' in method 'delete(index)'.");
         return BAD_VAL;
     }
     ObjList* list = AS_LIST(args[0]);
-    int index = AS_NUMBER(args[1]);
-    if (index > list->items.count) {
+    int index = AS_INTEGER(args[1]);
+    if (!validIndexList(vm, list, index)) {
         runtimeError(vm, "List index out of bounds (given %d, length %d).",
-                index, list->items.count-1);
+                index, list->items.count);
         return BAD_VAL;
     }
     deleteFromIndexList(vm, list, index);
     return NULL_VAL;
 }
 
+/**
+ * @brief Push value onto list head. Amortized O(1)
+ *
+ * @param vm 
+ * @param argCount 
+ * @param args 
+ * @return 
+ */
 static Value pushMethod(VM* vm, int argCount, Value* args) {
     prependMethod(vm, argCount, args);
     return NULL_VAL;
 }
 
 /**
- * @brief Pop value from list head. Deletes value as well.
+ * @brief Pop value from list head. Deletes value as well. O(1)
  *
  * @param vm 
  * @param argCount 
@@ -114,19 +107,19 @@ static Value pushMethod(VM* vm, int argCount, Value* args) {
  * @return 
  */
 static Value popMethod(VM* vm, int argCount, Value* args) {
-    if (argCount != 0) {
-        runtimeError(vm, "'pop()' expects no arguments (%d provided).",
-                argCount);
+    UNUSED(argCount);
+    ObjList* list = AS_LIST(args[0]);
+    if (list->items.count == 0) {
+        runtimeError(vm, "Cannot pop from an empty list.");
         return BAD_VAL;
     }
-    ObjList* list = AS_LIST(args[0]);
     Value out = list->items.values[0];
     deleteFromIndexList(vm, list, 0);
     return out;
 }
 
 /**
- * @brief Same as prepend. O(n)
+ * @brief Same as prepend. Amortized O(1)
  *
  * @param vm 
  * @param argCount 
@@ -139,7 +132,7 @@ static Value enqueueMethod(VM* vm, int argCount, Value* args) {
 }
 
 /**
- * @brief Dequeue value from list end. Deletes and returns value.
+ * @brief Dequeue value from list end. Deletes and returns value. O(1)
  *
  * @param vm 
  * @param argCount 
@@ -147,12 +140,12 @@ static Value enqueueMethod(VM* vm, int argCount, Value* args) {
  * @return 
  */
 static Value dequeueMethod(VM* vm, int argCount, Value* args) {
-    if (argCount != 0) {
-        runtimeError(vm, "'pop()' expects no arguments (%d provided)",
-                argCount);
+    UNUSED(argCount);
+    ObjList* list = AS_LIST(args[0]);
+    if (list->items.count == 0) {
+        runtimeError(vm, "Cannot dequeue from an empty list.");
         return BAD_VAL;
     }
-    ObjList* list = AS_LIST(args[0]);
     int outIdx = list->items.count-1;
     Value out = list->items.values[outIdx];
     deleteFromIndexList(vm, list, outIdx);
@@ -169,16 +162,13 @@ static Value dequeueMethod(VM* vm, int argCount, Value* args) {
  * @return 
  */
 static Value findMethod(VM* vm, int argCount, Value* args) {
-    if (argCount != 1) {
-        runtimeError(vm, "'find()' expects one argument (%d provided)",
-                argCount);
-        return BAD_VAL;
-    }
+    UNUSED(vm);
+    UNUSED(argCount);
     ObjList* list = AS_LIST(args[0]);
     Value compare = args[1];
     for (int i = 0; i < list->items.count; i++) {
         if (valuesEqual(list->items.values[i], compare)) {
-            return NUMBER_VAL(i);
+            return INT_VAL(i);
         }
     }
     return NULL_VAL;
@@ -193,11 +183,8 @@ static Value findMethod(VM* vm, int argCount, Value* args) {
  * @return 
  */
 static Value containsMethod(VM* vm, int argCount, Value* args) {
-    if (argCount != 1) {
-        runtimeError(vm, "'find()' expects one argument (%d provided).",
-                argCount);
-        return BAD_VAL;
-    }
+    UNUSED(vm);
+    UNUSED(argCount);
     ObjList* list = AS_LIST(args[0]);
     Value targ = args[1];
     for (int i = 0; i < list->items.count; i++) {
@@ -208,35 +195,115 @@ static Value containsMethod(VM* vm, int argCount, Value* args) {
     return FALSE_VAL;
 }
 
+/**
+ * @brief Appending all items of another list. O(k) in the added items
+ *
+ * @param vm 
+ * @param argCount 
+ * @param args 
+ * @return 
+ */
 static Value extendMethod(VM* vm, int argCount, Value* args) {
-    if (argCount != 1) {
-        runtimeError(vm, "'extend(list)' expects one argument (%d provided).",
-                argCount);
+    UNUSED(argCount);
+    if (!IS_LIST(args[1])) {
+        runtimeError(vm, "Argument to 'extend()' must be a list.");
         return BAD_VAL;
     }
-    ObjList* list = AS_LIST(args[0]);
-    ObjList* add = AS_LIST(args[1]);
-    for (int i = 0; i < add->items.count; i++) {
-        appendList(vm, list, add->items.values[i]);
+    extendList(vm, AS_LIST(args[0]), AS_LIST(args[1]));
+    return NULL_VAL;
+}
+
+/**
+ * @brief Making room for at least n items, so that the list can grow to n
+ * without reallocating. Does not change the length of the list.
+ *
+ * @param vm 
+ * @param argCount 
+ * @param args 
+ * @return 
+ */
+static Value reserveMethod(VM* vm, int argCount, Value* args) {
+    UNUSED(argCount);
+    // checked as a double, so that NaN and huge sizes never reach the int
+    if (!IS_NUMBER(args[1]) || !(AS_NUMBER(args[1]) >= 0) ||
+        AS_NUMBER(args[1]) > INT32_MAX) {
+        runtimeError(vm, "Argument to 'reserve()' must be a number from 0 to %d.",
+                     INT32_MAX);
+        return BAD_VAL;
     }
+    reserveList(vm, AS_LIST(args[0]), AS_INTEGER(args[1]));
     return NULL_VAL;
 }
 
-static Value lengthMethod(VM* vm, int argCount, Value* args) {
-    if (argCount != 0) {
-        runtimeError(vm, "'length()' expects exactly zero argument (%d provided).",
-                argCount);
+/**
+ * @brief Creating a list of n copies of a value, or of n nulls.
+ *
+ * @param vm 
+ * @param argCount 
+ * @param args 
+ * @return 
+ */
+static Value listNative(VM* vm, int argCount, Value* args) {
+    if (argCount != 1 && argCount != 2) {
+        runtimeError(vm, "Function List() expected 1 or 2 arguments but got %d.",
+                     argCount);
         return BAD_VAL;
     }
-    ObjList* list = AS_LIST(args[0]);
-    return NUMBER_VAL(list->items.count);
+    if (!IS_NUMBER(args[0]) || !(AS_NUMBER(args[0]) >= 0) ||
+        AS_NUMBER(args[0]) > INT32_MAX) {
+        runtimeError(vm, "List length must be a number from 0 to %d.",
+                     INT32_MAX);
+        return BAD_VAL;
+    }
+    int count = AS_INTEGER(args[0]);
+    Value fill = argCount == 2 ? args[1] : NULL_VAL;
+
+    ObjList* list = newList(vm);
+    push(vm, OBJ_VAL(list));
+    reserveList(vm, list, count);
+    for (int i = 0; i < count; i++) {
+        list->items.values[i] = fill;
+    }
+    list->items.count = count;
+    pop(vm);
+    return OBJ_VAL(list);
 }
 
-static Value reverseMethod(VM *vm, int argCount, Value *args) {
-    if (argCount != 0) {
-        runtimeError(vm, "reverse() takes no arguments (%d provided).", argCount);
+/**
+ * @brief Copying the items from index `start` up to `end` into a new list.
+ * Without `end` the slice runs to the end. O(k) in the slice length
+ *
+ * @param vm 
+ * @param argCount 
+ * @param args 
+ * @return 
+ */
+static Value sliceMethod(VM* vm, int argCount, Value* args) {
+    if (argCount != 1 && argCount != 2) {
+        runtimeError(vm, "Function slice() expected 1 or 2 arguments but got %d.",
+                     argCount);
         return BAD_VAL;
     }
+    ObjList* list = AS_LIST(args[0]);
+    int from, to;
+    if (!sliceRange(list->items.count, args[1], argCount == 2 ? args[2] : NULL_VAL,
+                    &from, &to)) {
+        runtimeError(vm, "Slice bounds must be numbers or null.");
+        return BAD_VAL;
+    }
+    return OBJ_VAL(sliceList(vm, list, from, to));
+}
+
+static Value lengthMethod(VM* vm, int argCount, Value* args) {
+    UNUSED(vm);
+    UNUSED(argCount);
+    ObjList* list = AS_LIST(args[0]);
+    return INT_VAL(list->items.count);
+}
+
+static Value reverseMethod(VM *vm, int argCount, Value *args) {
+    UNUSED(vm);
+    UNUSED(argCount);
 
     ObjList *list = AS_LIST(args[0]);
     int listLength = list->items.count;
@@ -249,18 +316,383 @@ static Value reverseMethod(VM *vm, int argCount, Value *args) {
     return NULL_VAL;
 }
 
+/**
+ * @brief New list holding the callback's result for every item. O(n)
+ *
+ * @param vm 
+ * @param argCount 
+ * @param args 
+ * @return 
+ */
+static Value mapMethod(VM* vm, int argCount, Value* args) {
+    UNUSED(argCount);
+    ObjList* list = AS_LIST(args[0]);
+    Value callback = args[1];
+    ObjList* result = newList(vm);
+    push(vm, OBJ_VAL(result));
+    reserveList(vm, result, list->items.count);
+
+    for (int i = 0; i < list->items.count; i++) {
+        Value item = list->items.values[i];
+        Value mapped;
+        if (!vmCall(vm, callback, 1, &item, &mapped)) return BAD_VAL;
+        push(vm, mapped);
+        appendList(vm, result, mapped);
+        pop(vm);
+    }
+    pop(vm);
+    return OBJ_VAL(result);
+}
+
+/**
+ * @brief New list of the items the callback returns a truthy value for. O(n)
+ *
+ * @param vm 
+ * @param argCount 
+ * @param args 
+ * @return 
+ */
+static Value filterMethod(VM* vm, int argCount, Value* args) {
+    UNUSED(argCount);
+    ObjList* list = AS_LIST(args[0]);
+    Value callback = args[1];
+    ObjList* result = newList(vm);
+    push(vm, OBJ_VAL(result));
+    reserveList(vm, result, list->items.count);
+
+    for (int i = 0; i < list->items.count; i++) {
+        // the callback could remove the item from the list
+        Value item = list->items.values[i];
+        push(vm, item);
+        Value keep;
+        if (!vmCall(vm, callback, 1, &item, &keep)) return BAD_VAL;
+        if (!isFalsey(keep)) appendList(vm, result, item);
+        pop(vm);
+    }
+    pop(vm);
+    return OBJ_VAL(result);
+}
+
+/**
+ * @brief Folding the list into one value, calling the callback with the
+ * value so far and each item. Starts from the given initial value, or from
+ * the first item. O(n)
+ *
+ * @param vm 
+ * @param argCount 
+ * @param args 
+ * @return 
+ */
+static Value reduceMethod(VM* vm, int argCount, Value* args) {
+    if (argCount != 1 && argCount != 2) {
+        runtimeError(vm, "Function reduce() expected 1 or 2 arguments but got %d.",
+                     argCount);
+        return BAD_VAL;
+    }
+    ObjList* list = AS_LIST(args[0]);
+    Value callback = args[1];
+    Value acc;
+    int start = 0;
+    if (argCount == 2) {
+        acc = args[2];
+    } else if (list->items.count > 0) {
+        acc = list->items.values[0];
+        start = 1;
+    } else {
+        runtimeError(vm, "Cannot reduce an empty list without an initial value.");
+        return BAD_VAL;
+    }
+
+    for (int i = start; i < list->items.count; i++) {
+        Value pair[2] = {acc, list->items.values[i]};
+        if (!vmCall(vm, callback, 2, pair, &acc)) return BAD_VAL;
+    }
+    return acc;
+}
+
+/**
+ * @brief Calling the callback with every item. O(n)
+ *
+ * @param vm 
+ * @param argCount 
+ * @param args 
+ * @return 
+ */
+static Value forEachMethod(VM* vm, int argCount, Value* args) {
+    UNUSED(argCount);
+    ObjList* list = AS_LIST(args[0]);
+    Value callback = args[1];
+    for (int i = 0; i < list->items.count; i++) {
+        Value item = list->items.values[i];
+        Value ignored;
+        if (!vmCall(vm, callback, 1, &item, &ignored)) return BAD_VAL;
+    }
+    return NULL_VAL;
+}
+
+/**
+ * @brief Checking the callback's result for each item until one is equal to
+ * `stopOn`, which is then returned. Shared by any() and all().
+ *
+ */
+static Value findTruth(VM* vm, Value* args, bool stopOn) {
+    ObjList* list = AS_LIST(args[0]);
+    Value callback = args[1];
+    for (int i = 0; i < list->items.count; i++) {
+        Value item = list->items.values[i];
+        Value result;
+        if (!vmCall(vm, callback, 1, &item, &result)) return BAD_VAL;
+        if (!isFalsey(result) == stopOn) return BOOL_VAL(stopOn);
+    }
+    return BOOL_VAL(!stopOn);
+}
+
+/**
+ * @brief True if the callback returns a truthy value for any item. Stops at
+ * the first one. O(n)
+ *
+ * @param vm 
+ * @param argCount 
+ * @param args 
+ * @return 
+ */
+static Value anyMethod(VM* vm, int argCount, Value* args) {
+    UNUSED(argCount);
+    return findTruth(vm, args, true);
+}
+
+/**
+ * @brief True if the callback returns a truthy value for every item. Stops
+ * at the first falsey one. O(n)
+ *
+ * @param vm 
+ * @param argCount 
+ * @param args 
+ * @return 
+ */
+static Value allMethod(VM* vm, int argCount, Value* args) {
+    UNUSED(argCount);
+    return findTruth(vm, args, false);
+}
+
+/**
+ * @brief State shared by the comparisons of one sort
+ *
+ */
+typedef struct {
+    VM* vm;
+    Value comparator; // script function, or null for the natural order
+    bool failed;      // set once the comparator raised an error
+} Sorter;
+
+typedef bool (*LessFn)(Sorter* sorter, Value a, Value b);
+
+#define SORT_INSERTION_MAX 16
+
+static bool numberLess(Sorter* sorter, Value a, Value b) {
+    UNUSED(sorter);
+    return AS_NUMBER(a) < AS_NUMBER(b);
+}
+
+static bool stringLess(Sorter* sorter, Value a, Value b) {
+    UNUSED(sorter);
+    ObjString* x = AS_STRING(a);
+    ObjString* y = AS_STRING(b);
+    int length = x->length < y->length ? x->length : y->length;
+    int order = memcmp(x->chars, y->chars, length);
+    return order < 0 || (order == 0 && x->length < y->length);
+}
+
+/**
+ * @brief Comparing through the script comparator. It may return a boolean,
+ * true if `a` goes first, or a number that is negative if `a` goes first.
+ * After an error every comparison is false, so the sort just runs out.
+ *
+ */
+static bool comparatorLess(Sorter* sorter, Value a, Value b) {
+    if (sorter->failed) return false;
+    Value args[2] = {a, b};
+    Value result;
+    if (!vmCall(sorter->vm, sorter->comparator, 2, args, &result)) {
+        sorter->failed = true;
+        return false;
+    }
+    if (IS_BOOL(result)) return AS_BOOL(result);
+    if (IS_NUMBER(result)) return AS_NUMBER(result) < 0;
+    runtimeError(sorter->vm, "Comparator must return a number or a boolean.");
+    sorter->failed = true;
+    return false;
+}
+
+static void swapValues(Value* values, int i, int j) {
+    Value temp = values[i];
+    values[i] = values[j];
+    values[j] = temp;
+}
+
+static void insertionSort(Value* values, int lo, int hi, LessFn less,
+                          Sorter* sorter) {
+    for (int i = lo + 1; i < hi; i++) {
+        Value value = values[i];
+        int j = i;
+        for (; j > lo && less(sorter, value, values[j-1]); j--) {
+            values[j] = values[j-1];
+        }
+        values[j] = value;
+    }
+}
+
+static void siftDown(Value* values, int lo, int root, int count, LessFn less,
+                     Sorter* sorter) {
+    for (;;) {
+        int child = 2 * root + 1;
+        if (child >= count) return;
+        if (child + 1 < count &&
+            less(sorter, values[lo+child], values[lo+child+1])) child++;
+        if (!less(sorter, values[lo+root], values[lo+child])) return;
+        swapValues(values, lo+root, lo+child);
+        root = child;
+    }
+}
+
+static void heapSort(Value* values, int lo, int hi, LessFn less,
+                     Sorter* sorter) {
+    int count = hi - lo;
+    for (int i = count / 2 - 1; i >= 0; i--) {
+        siftDown(values, lo, i, count, less, sorter);
+    }
+    for (int end = count - 1; end > 0; end--) {
+        swapValues(values, lo, lo+end);
+        siftDown(values, lo, 0, end, less, sorter);
+    }
+}
+
+/**
+ * @brief Introsort over [lo, hi): quicksort with a median of three pivot,
+ * switching to heapsort once `depth` runs out and to insertion sort for
+ * short ranges. The partition scans are bounded, so a comparator that is
+ * not a consistent order gives a shuffled list but never reads past it.
+ *
+ */
+static void introSort(Value* values, int lo, int hi, int depth, LessFn less,
+                      Sorter* sorter) {
+    while (hi - lo > SORT_INSERTION_MAX) {
+        if (depth-- == 0) {
+            heapSort(values, lo, hi, less, sorter);
+            return;
+        }
+        int mid = lo + (hi - lo) / 2;
+        if (less(sorter, values[mid], values[lo])) swapValues(values, lo, mid);
+        if (less(sorter, values[hi-1], values[mid])) {
+            swapValues(values, mid, hi-1);
+            if (less(sorter, values[mid], values[lo]))
+                swapValues(values, lo, mid);
+        }
+        Value pivot = values[mid];
+
+        int i = lo, j = hi - 1;
+        for (;;) {
+            do { i++; } while (i < hi - 1 && less(sorter, values[i], pivot));
+            do { j--; } while (j > lo && less(sorter, pivot, values[j]));
+            if (i >= j) break;
+            swapValues(values, i, j);
+        }
+
+        // [lo, i) holds the values before the pivot, [i, hi) the rest
+        if (i - lo < hi - i) {
+            introSort(values, lo, i, depth, less, sorter);
+            lo = i;
+        } else {
+            introSort(values, i, hi, depth, less, sorter);
+            hi = i;
+        }
+    }
+    insertionSort(values, lo, hi, less, sorter);
+}
+
+static void sortValues(Value* values, int count, LessFn less, Sorter* sorter) {
+    int depth = 0;
+    for (int n = count; n > 1; n >>= 1) depth += 2;
+    introSort(values, 0, count, depth, less, sorter);
+}
+
+/**
+ * @brief Sorting the list in place. O(n log n). Without arguments, lists
+ * of only numbers or only strings are sorted in their natural order.
+ * Otherwise the argument is called to compare two values.
+ *
+ * @param vm 
+ * @param argCount 
+ * @param args 
+ * @return 
+ */
+static Value sortMethod(VM* vm, int argCount, Value* args) {
+    ObjList* list = AS_LIST(args[0]);
+    Sorter sorter = {vm, NULL_VAL, false};
+    int count = list->items.count;
+
+    if (argCount == 0) {
+        bool numbers = true;
+        bool strings = true;
+        for (int i = 0; i < count; i++) {
+            numbers = numbers && IS_NUMBER(list->items.values[i]);
+            strings = strings && IS_STRING(list->items.values[i]);
+        }
+        if (!numbers && !strings) {
+            runtimeError(vm, "sort() needs a comparator for lists that are not all numbers or all strings.");
+            return BAD_VAL;
+        }
+        sortValues(list->items.values, count,
+                   numbers ? numberLess : stringLess, &sorter);
+        return NULL_VAL;
+    }
+    if (argCount > 1) {
+        runtimeError(vm, "Function sort() expected 0 or 1 arguments but got %d.",
+                     argCount);
+        return BAD_VAL;
+    }
+
+    // the comparator could change the list, so the sort works on a copy
+    sorter.comparator = args[1];
+    ObjList* work = newList(vm);
+    push(vm, OBJ_VAL(work));
+    for (int i = 0; i < count; i++) {
+        appendList(vm, work, list->items.values[i]);
+    }
+    sortValues(work->items.values, count, comparatorLess, &sorter);
+    if (sorter.failed) return BAD_VAL;
+
+    clearList(vm, list);
+    for (int i = 0; i < count; i++) {
+        appendList(vm, list, work->items.values[i]);
+    }
+    pop(vm);
+    return NULL_VAL;
+}
+
 void defineListMethods(VM* vm) {
-    defineNative(vm, &vm->listMethods, "append", appendMethod);
-    defineNative(vm, &vm->listMethods, "prepend", prependMethod);
-    defineNative(vm, &vm->listMethods, "length", lengthMethod);
-    defineNative(vm, &vm->listMethods, "contains", containsMethod);
-    defineNative(vm, &vm->listMethods, "find", findMethod);
-    defineNative(vm, &vm->listMethods, "delete", deleteMethod);
-    defineNative(vm, &vm->listMethods, "insert", insertMethod);
-    defineNative(vm, &vm->listMethods, "push", pushMethod);
-    defineNative(vm, &vm->listMethods, "pop", popMethod);
-    defineNative(vm, &vm->listMethods, "enqueue", enqueueMethod);
-    defineNative(vm, &vm->listMethods, "dequeue", dequeueMethod);
-    defineNative(vm, &vm->listMethods, "extend", extendMethod);
-    defineNative(vm, &vm->listMethods, "reverse", reverseMethod);
+    defineNative(vm, &vm->globals, "List", ARITY_ANY, listNative);
+
+    defineNative(vm, &vm->listMethods, "append", 1, appendMethod);
+    defineNative(vm, &vm->listMethods, "prepend", 1, prependMethod);
+    defineNative(vm, &vm->listMethods, "length", 0, lengthMethod);
+    defineNative(vm, &vm->listMethods, "contains", 1, containsMethod);
+    defineNative(vm, &vm->listMethods, "find", 1, findMethod);
+    defineNative(vm, &vm->listMethods, "delete", 1, deleteMethod);
+    defineNative(vm, &vm->listMethods, "insert", 2, insertMethod);
+    defineNative(vm, &vm->listMethods, "push", 1, pushMethod);
+    defineNative(vm, &vm->listMethods, "pop", 0, popMethod);
+    defineNative(vm, &vm->listMethods, "enqueue", 1, enqueueMethod);
+    defineNative(vm, &vm->listMethods, "dequeue", 0, dequeueMethod);
+    defineNative(vm, &vm->listMethods, "extend", 1, extendMethod);
+    defineNative(vm, &vm->listMethods, "reserve", 1, reserveMethod);
+    defineNative(vm, &vm->listMethods, "reverse", 0, reverseMethod);
+    defineNative(vm, &vm->listMethods, "sort", ARITY_ANY, sortMethod);
+    defineNative(vm, &vm->listMethods, "slice", ARITY_ANY, sliceMethod);
+    defineNative(vm, &vm->listMethods, "map", 1, mapMethod);
+    defineNative(vm, &vm->listMethods, "filter", 1, filterMethod);
+    defineNative(vm, &vm->listMethods, "reduce", ARITY_ANY, reduceMethod);
+    defineNative(vm, &vm->listMethods, "forEach", 1, forEachMethod);
+    defineNative(vm, &vm->listMethods, "any", 1, anyMethod);
+    defineNative(vm, &vm->listMethods, "all", 1, allMethod);
 }
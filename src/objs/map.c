@@ -0,0 +1,149 @@
+#include "map.h"
+#include "../natives.h"
+
+bool validMapKey(VM* vm, Value key) {
+    if (IS_NULL(key)) {
+        runtimeError(vm, "Map keys and set members cannot be null.");
+        return false;
+    }
+    if (IS_NUMBER(key) && AS_NUMBER(key) != AS_NUMBER(key)) {
+        runtimeError(vm, "Map keys and set members cannot be NaN.");
+        return false;
+    }
+    return true;
+}
+
+bool setMapKey(VM* vm, ObjMap* map, Value key, Value value) {
+    if (!validMapKey(vm, key)) return false;
+    valueTableSet(vm, &map->table, key, value);
+    return true;
+}
+
+static Value lengthMethod(VM* vm, int argCount, Value* args) {
+    UNUSED(vm);
+    UNUSED(argCount);
+    return INT_VAL(AS_MAP(args[0])->table.live);
+}
+
+/**
+ * @brief Getting the value of a key, or the default value (null if not
+ * given) when the key is missing. O(1)
+ *
+ * @param vm 
+ * @param argCount 
+ * @param args 
+ * @return 
+ */
+static Value getMethod(VM* vm, int argCount, Value* args) {
+    if (argCount != 1 && argCount != 2) {
+        runtimeError(vm, "Function get() expected 1 or 2 arguments but got %d.",
+                     argCount);
+        return BAD_VAL;
+    }
+    Value value;
+    if (valueTableGet(&AS_MAP(args[0])->table, args[1], &value)) {
+        return value;
+    }
+    return argCount == 2 ? args[2] : NULL_VAL;
+}
+
+/**
+ * @brief Setting the value of a key, adding the key if it is missing.
+ * Amortized O(1)
+ *
+ * @param vm 
+ * @param argCount 
+ * @param args 
+ * @return 
+ */
+static Value setMethod(VM* vm, int argCount, Value* args) {
+    UNUSED(argCount);
+    if (!setMapKey(vm, AS_MAP(args[0]), args[1], args[2])) return BAD_VAL;
+    return NULL_VAL;
+}
+
+/**
+ * @brief Removing a key. Returns whether the key was there. O(1)
+ *
+ * @param vm 
+ * @param argCount 
+ * @param args 
+ * @return 
+ */
+static Value deleteMethod(VM* vm, int argCount, Value* args) {
+    UNUSED(vm);
+    UNUSED(argCount);
+    return BOOL_VAL(valueTableDelete(&AS_MAP(args[0])->table, args[1]));
+}
+
+/**
+ * @brief Checking whether a map has a key. O(1)
+ *
+ * @param vm 
+ * @param argCount 
+ * @param args 
+ * @return 
+ */
+static Value hasMethod(VM* vm, int argCount, Value* args) {
+    UNUSED(vm);
+    UNUSED(argCount);
+    Value value;
+    return BOOL_VAL(valueTableGet(&AS_MAP(args[0])->table, args[1], &value));
+}
+
+/**
+ * @brief Collecting the keys, or the values, of a map into a new list, in
+ * the order they are stored in. O(n)
+ *
+ * @param map 
+ * @param keys True to collect the keys, false for the values
+ * @return ObjList* 
+ */
+static ObjList* collectEntries(VM* vm, ObjMap* map, bool keys) {
+    ValueTable* table = &map->table;
+    ObjList* list = newList(vm);
+    push(vm, OBJ_VAL(list));
+    reserveList(vm, list, table->live);
+    for (int i = 0; i < table->capacity; i++) {
+        ValueEntry* entry = &table->entries[i];
+        if (IS_NULL(entry->key)) continue;
+        list->items.values[list->items.count++] = keys ? entry->key : entry->value;
+    }
+    pop(vm);
+    return list;
+}
+
+static Value keysMethod(VM* vm, int argCount, Value* args) {
+    UNUSED(argCount);
+    return OBJ_VAL(collectEntries(vm, AS_MAP(args[0]), true));
+}
+
+static Value valuesMethod(VM* vm, int argCount, Value* args) {
+    UNUSED(argCount);
+    return OBJ_VAL(collectEntries(vm, AS_MAP(args[0]), false));
+}
+
+/**
+ * @brief Removing every key from a map. O(n)
+ *
+ * @param vm 
+ * @param argCount 
+ * @param args 
+ * @return 
+ */
+static Value clearMethod(VM* vm, int argCount, Value* args) {
+    UNUSED(argCount);
+    freeValueTable(vm, &AS_MAP(args[0])->table);
+    return NULL_VAL;
+}
+
+void defineMapMethods(VM* vm) {
+    defineNative(vm, &vm->mapMethods, "length", 0, lengthMethod);
+    defineNative(vm, &vm->mapMethods, "get", ARITY_ANY, getMethod);
+    defineNative(vm, &vm->mapMethods, "set", 2, setMethod);
+    defineNative(vm, &vm->mapMethods, "delete", 1, deleteMethod);
+    defineNative(vm, &vm->mapMethods, "has", 1, hasMethod);
+    defineNative(vm, &vm->mapMethods, "keys", 0, keysMethod);
+    defineNative(vm, &vm->mapMethods, "values", 0, valuesMethod);
+    defineNative(vm, &vm->mapMethods, "clear", 0, clearMethod);
+}
@@ -0,0 +1,28 @@
+#ifndef simscript_map_h
+#define simscript_map_h
+
+#include "../vm.h"
+
+/**
+ * @brief Method to check that a value can be a map or set key. Null and
+ * NaN cannot be keys, since null marks empty slots and NaN is not equal to
+ * itself.
+ *
+ * @param key The key to check
+ * @return bool False after a runtime error
+ */
+bool validMapKey(VM* vm, Value key);
+
+/**
+ * @brief Method to set a key of a map, raising an error for invalid keys
+ *
+ * @param map The map to set the key in
+ * @param key The key to set
+ * @param value The value for the key
+ * @return bool False after a runtime error
+ */
+bool setMapKey(VM* vm, ObjMap* map, Value key, Value value);
+
+void defineMapMethods(VM* vm);
+
+#endif
@@ -0,0 +1,81 @@
+#include <math.h>
+
+#include "range.h"
+#include "../natives.h"
+
+/**
+ * @brief Creating a range with `range(end)`, `range(start, end)` or
+ * `range(start, end, step)`. The values are not stored, so this is O(1)
+ *
+ * @param vm
+ * @param argCount
+ * @param args
+ * @return
+ */
+static Value rangeNative(VM* vm, int argCount, Value* args) {
+    if (argCount < 1 || argCount > 3) {
+        runtimeError(vm, "Function range() expected 1 to 3 arguments but got %d.",
+                     argCount);
+        return BAD_VAL;
+    }
+    for (int i = 0; i < argCount; i++) {
+        if (!IS_NUMBER(args[i])) {
+            runtimeError(vm, "Arguments to 'range()' must be numbers.");
+            return BAD_VAL;
+        }
+    }
+    double start = argCount == 1 ? 0 : AS_NUMBER(args[0]);
+    double end = argCount == 1 ? AS_NUMBER(args[0]) : AS_NUMBER(args[1]);
+    double step = argCount == 3 ? AS_NUMBER(args[2]) : 1;
+    if (isnan(start) || isnan(end) || isnan(step)) {
+        runtimeError(vm, "Arguments to 'range()' cannot be NaN.");
+        return BAD_VAL;
+    }
+    if (step == 0) {
+        runtimeError(vm, "Range step cannot be zero.");
+        return BAD_VAL;
+    }
+
+    double count = ceil((end - start) / step);
+    if (count < 0) count = 0;
+    if (count > INT32_MAX) {
+        runtimeError(vm, "Range is too long (%g values).", count);
+        return BAD_VAL;
+    }
+    return OBJ_VAL(newRange(vm, start, end, step, (int)count));
+}
+
+static Value lengthMethod(VM* vm, int argCount, Value* args) {
+    UNUSED(vm);
+    UNUSED(argCount);
+    return INT_VAL(AS_RANGE(args[0])->count);
+}
+
+/**
+ * @brief Collecting the values of a range into a new list. O(n)
+ *
+ * @param vm
+ * @param argCount
+ * @param args
+ * @return
+ */
+static Value toListMethod(VM* vm, int argCount, Value* args) {
+    UNUSED(argCount);
+    ObjRange* range = AS_RANGE(args[0]);
+    ObjList* list = newList(vm);
+    push(vm, OBJ_VAL(list));
+    reserveList(vm, list, range->count);
+    for (int i = 0; i < range->count; i++) {
+        list->items.values[i] = rangeValue(range, i);
+    }
+    list->items.count = range->count;
+    pop(vm);
+    return OBJ_VAL(list);
+}
+
+void defineRangeMethods(VM* vm) {
+    defineNative(vm, &vm->globals, "range", ARITY_ANY, rangeNative);
+
+    defineNative(vm, &vm->rangeMethods, "length", 0, lengthMethod);
+    defineNative(vm, &vm->rangeMethods, "toList", 0, toListMethod);
+}
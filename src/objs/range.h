@@ -0,0 +1,8 @@
+#ifndef simscript_range_h
+#define simscript_range_h
+
+#include "../vm.h"
+
+void defineRangeMethods(VM* vm);
+
+#endif
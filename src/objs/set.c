@@ -0,0 +1,284 @@
+#include "set.h"
+#include "map.h"
+#include "../natives.h"
+
+/*
+ * Sets are ValueTables whose values are all true, so they share hashing,
+ * key rules and growth with maps. The set algebra methods walk the entry
+ * arrays directly instead of calling back into the VM per element.
+ */
+
+/**
+ * @brief Method to add a value to a set, raising an error for invalid keys
+ *
+ * @return bool False after a runtime error
+ */
+static bool addToSet(VM* vm, ObjSet* set, Value value) {
+    if (!validMapKey(vm, value)) return false;
+    valueTableSet(vm, &set->table, value, BOOL_VAL(true));
+    return true;
+}
+
+/**
+ * @brief Method to check that a method argument is a set
+ *
+ * @param vm
+ * @param arg The argument to check
+ * @param method Name of the method, for the error message
+ * @return ObjSet* The argument set, or NULL after a runtime error
+ */
+static ObjSet* setArgument(VM* vm, Value arg, const char* method) {
+    if (!IS_SET(arg)) {
+        runtimeError(vm, "Argument to '%s()' must be a set.", method);
+        return NULL;
+    }
+    return AS_SET(arg);
+}
+
+/**
+ * @brief Creating a set, either empty or holding the items of a list or
+ * another set. O(n)
+ *
+ * @param vm
+ * @param argCount
+ * @param args
+ * @return
+ */
+static Value setNative(VM* vm, int argCount, Value* args) {
+    if (argCount > 1) {
+        runtimeError(vm, "Function Set() expected 0 or 1 arguments but got %d.",
+                     argCount);
+        return BAD_VAL;
+    }
+    if (argCount == 1 && !IS_LIST(args[0]) && !IS_SET(args[0])) {
+        runtimeError(vm, "Set() takes a list or a set.");
+        return BAD_VAL;
+    }
+    ObjSet* set = newSet(vm);
+    if (argCount == 0) return OBJ_VAL(set);
+
+    push(vm, OBJ_VAL(set));
+    if (IS_SET(args[0])) {
+        valueTableAddAll(vm, &AS_SET(args[0])->table, &set->table);
+    } else {
+        ObjList* list = AS_LIST(args[0]);
+        for (int i = 0; i < list->items.count; i++) {
+            if (!addToSet(vm, set, list->items.values[i])) return BAD_VAL;
+        }
+    }
+    pop(vm);
+    return OBJ_VAL(set);
+}
+
+static Value lengthMethod(VM* vm, int argCount, Value* args) {
+    UNUSED(vm);
+    UNUSED(argCount);
+    return INT_VAL(AS_SET(args[0])->table.live);
+}
+
+/**
+ * @brief Adding a value to a set. Returns whether it was not already in
+ * the set. Amortized O(1)
+ *
+ * @param vm
+ * @param argCount
+ * @param args
+ * @return
+ */
+static Value addMethod(VM* vm, int argCount, Value* args) {
+    UNUSED(argCount);
+    ObjSet* set = AS_SET(args[0]);
+    int live = set->table.live;
+    if (!addToSet(vm, set, args[1])) return BAD_VAL;
+    return BOOL_VAL(set->table.live != live);
+}
+
+/**
+ * @brief Removing a value from a set. Returns whether it was in the set. O(1)
+ *
+ * @param vm
+ * @param argCount
+ * @param args
+ * @return
+ */
+static Value deleteMethod(VM* vm, int argCount, Value* args) {
+    UNUSED(vm);
+    UNUSED(argCount);
+    return BOOL_VAL(valueTableDelete(&AS_SET(args[0])->table, args[1]));
+}
+
+/**
+ * @brief Checking whether a value is in a set. O(1)
+ *
+ * @param vm
+ * @param argCount
+ * @param args
+ * @return
+ */
+static Value hasMethod(VM* vm, int argCount, Value* args) {
+    UNUSED(vm);
+    UNUSED(argCount);
+    Value value;
+    return BOOL_VAL(valueTableGet(&AS_SET(args[0])->table, args[1], &value));
+}
+
+/**
+ * @brief Collecting the members of a set into a new list. O(n)
+ *
+ * @param vm
+ * @param argCount
+ * @param args
+ * @return
+ */
+static Value toListMethod(VM* vm, int argCount, Value* args) {
+    UNUSED(argCount);
+    ValueTable* table = &AS_SET(args[0])->table;
+    ObjList* list = newList(vm);
+    push(vm, OBJ_VAL(list));
+    reserveList(vm, list, table->live);
+    for (int i = 0; i < table->capacity; i++) {
+        ValueEntry* entry = &table->entries[i];
+        if (IS_NULL(entry->key)) continue;
+        list->items.values[list->items.count++] = entry->key;
+    }
+    pop(vm);
+    return OBJ_VAL(list);
+}
+
+/**
+ * @brief The members of either set, as a new set. O(n + m)
+ *
+ * @param vm
+ * @param argCount
+ * @param args
+ * @return
+ */
+static Value unionMethod(VM* vm, int argCount, Value* args) {
+    UNUSED(argCount);
+    ObjSet* other = setArgument(vm, args[1], "union");
+    if (other == NULL) return BAD_VAL;
+    ObjSet* set = AS_SET(args[0]);
+
+    // starting from the larger set saves rehashing most of the members
+    ObjSet* larger = set->table.live >= other->table.live ? set : other;
+    ObjSet* smaller = larger == set ? other : set;
+    ObjSet* result = newSet(vm);
+    push(vm, OBJ_VAL(result));
+    valueTableAddAll(vm, &larger->table, &result->table);
+    valueTableAddAll(vm, &smaller->table, &result->table);
+    pop(vm);
+    return OBJ_VAL(result);
+}
+
+/**
+ * @brief The members of both sets, as a new set. O(min(n, m))
+ *
+ * @param vm
+ * @param argCount
+ * @param args
+ * @return
+ */
+static Value intersectionMethod(VM* vm, int argCount, Value* args) {
+    UNUSED(argCount);
+    ObjSet* other = setArgument(vm, args[1], "intersection");
+    if (other == NULL) return BAD_VAL;
+    ObjSet* set = AS_SET(args[0]);
+
+    // probing the larger set for each member of the smaller one
+    ValueTable* larger = set->table.live >= other->table.live ?
+                         &set->table : &other->table;
+    ValueTable* smaller = larger == &set->table ? &other->table : &set->table;
+    ObjSet* result = newSet(vm);
+    push(vm, OBJ_VAL(result));
+    for (int i = 0; i < smaller->capacity; i++) {
+        ValueEntry* entry = &smaller->entries[i];
+        Value value;
+        if (IS_NULL(entry->key) || !valueTableGet(larger, entry->key, &value))
+            continue;
+        valueTableSet(vm, &result->table, entry->key, entry->value);
+    }
+    pop(vm);
+    return OBJ_VAL(result);
+}
+
+/**
+ * @brief The members of this set that are not in the other, as a new set. O(n)
+ *
+ * @param vm
+ * @param argCount
+ * @param args
+ * @return
+ */
+static Value differenceMethod(VM* vm, int argCount, Value* args) {
+    UNUSED(argCount);
+    ObjSet* other = setArgument(vm, args[1], "difference");
+    if (other == NULL) return BAD_VAL;
+    ValueTable* table = &AS_SET(args[0])->table;
+
+    ObjSet* result = newSet(vm);
+    push(vm, OBJ_VAL(result));
+    for (int i = 0; i < table->capacity; i++) {
+        ValueEntry* entry = &table->entries[i];
+        Value value;
+        if (IS_NULL(entry->key) ||
+            valueTableGet(&other->table, entry->key, &value))
+            continue;
+        valueTableSet(vm, &result->table, entry->key, entry->value);
+    }
+    pop(vm);
+    return OBJ_VAL(result);
+}
+
+/**
+ * @brief Checking whether every member of this set is in the other. O(n)
+ *
+ * @param vm
+ * @param argCount
+ * @param args
+ * @return
+ */
+static Value isSubsetMethod(VM* vm, int argCount, Value* args) {
+    UNUSED(argCount);
+    ObjSet* other = setArgument(vm, args[1], "isSubset");
+    if (other == NULL) return BAD_VAL;
+    ValueTable* table = &AS_SET(args[0])->table;
+    if (table->live > other->table.live) return BOOL_VAL(false);
+
+    for (int i = 0; i < table->capacity; i++) {
+        ValueEntry* entry = &table->entries[i];
+        Value value;
+        if (!IS_NULL(entry->key) &&
+            !valueTableGet(&other->table, entry->key, &value))
+            return BOOL_VAL(false);
+    }
+    return BOOL_VAL(true);
+}
+
+/**
+ * @brief Removing every member from a set. O(n)
+ *
+ * @param vm
+ * @param argCount
+ * @param args
+ * @return
+ */
+static Value clearMethod(VM* vm, int argCount, Value* args) {
+    UNUSED(argCount);
+    freeValueTable(vm, &AS_SET(args[0])->table);
+    return NULL_VAL;
+}
+
+void defineSetMethods(VM* vm) {
+    defineNative(vm, &vm->globals, "Set", ARITY_ANY, setNative);
+
+    defineNative(vm, &vm->setMethods, "length", 0, lengthMethod);
+    defineNative(vm, &vm->setMethods, "add", 1, addMethod);
+    defineNative(vm, &vm->setMethods, "delete", 1, deleteMethod);
+    defineNative(vm, &vm->setMethods, "has", 1, hasMethod);
+    defineNative(vm, &vm->setMethods, "toList", 0, toListMethod);
+    defineNative(vm, &vm->setMethods, "union", 1, unionMethod);
+    defineNative(vm, &vm->setMethods, "intersection", 1, intersectionMethod);
+    defineNative(vm, &vm->setMethods, "difference", 1, differenceMethod);
+    defineNative(vm, &vm->setMethods, "isSubset", 1, isSubsetMethod);
+    defineNative(vm, &vm->setMethods, "clear", 0, clearMethod);
+}
@@ -0,0 +1,8 @@
+#ifndef simscript_set_h
+#define simscript_set_h
+
+#include "../vm.h"
+
+void defineSetMethods(VM* vm);
+
+#endif
@@ -2,15 +2,38 @@
 #include "../natives.h"
 
 static Value lengthMethod(VM* vm, int argCount, Value* args) {
-    if (argCount != 0) {
-        runtimeError(vm, "'length()' takes no argument (%d provided).",
-                argCount);
+    UNUSED(vm);
+    UNUSED(argCount);
+    ObjString* str = AS_STRING(args[0]);
+    return INT_VAL(str->length);
+}
+
+/**
+ * @brief Copying the characters from index `start` up to `end` into a new string.
+ * Without `end` the slice runs to the end. O(k) in the slice length
+ *
+ * @param vm 
+ * @param argCount 
+ * @param args 
+ * @return 
+ */
+static Value sliceMethod(VM* vm, int argCount, Value* args) {
+    if (argCount != 1 && argCount != 2) {
+        runtimeError(vm, "Function slice() expected 1 or 2 arguments but got %d.",
+                     argCount);
         return BAD_VAL;
     }
     ObjString* str = AS_STRING(args[0]);
-    return NUMBER_VAL(str->length);
+    int from, to;
+    if (!sliceRange(str->length, args[1], argCount == 2 ? args[2] : NULL_VAL,
+                    &from, &to)) {
+        runtimeError(vm, "Slice bounds must be numbers or null.");
+        return BAD_VAL;
+    }
+    return OBJ_VAL(copyString(vm, str->chars + from, to - from));
 }
 
 void defineStringMethods(VM* vm) {
-    defineNative(vm, &vm->stringMethods, "length", lengthMethod);
+    defineNative(vm, &vm->stringMethods, "length", 0, lengthMethod);
+    defineNative(vm, &vm->stringMethods, "slice", ARITY_ANY, sliceMethod);
 }
@@ -0,0 +1,802 @@
+#include <string.h>
+
+#include "chunk.h"
+#include "memory.h"
+#include "optimizer.h"
+#include "vm.h"
+
+#define OPTIMIZE_MAX_PASSES 8
+#define THREAD_MAX_HOPS     16
+#define TAIL_MAX_LENGTH     4  // instructions copied in place of a jump
+#define TAIL_MAX_ROUNDS     2
+
+/**
+ * @brief Decoded instruction used while rewriting a chunk
+ *
+ */
+typedef struct {
+    int offset;    // offset of the opcode in the original code
+    int length;    // size in bytes, only ever shrinks when rewritten
+    int target;    // index of the instruction jumped to, -1 if not a jump
+    bool isTarget; // if a live jump lands on this instruction
+    bool removed;
+} Instruction;
+
+/**
+ * @brief Working state of the optimizer. The instruction array holds one
+ * extra sentinel entry standing for the end of the chunk.
+ *
+ */
+typedef struct {
+    Chunk* chunk;
+    Instruction* code;
+    int count;
+} Optimizer;
+
+static inline uint8_t opcode(Optimizer* opt, int index) {
+    return opt->chunk->code[opt->code[index].offset];
+}
+
+static inline uint8_t operand(Optimizer* opt, int index) {
+    return opt->chunk->code[opt->code[index].offset+1];
+}
+
+static inline bool isJump(uint8_t op) {
+    return op == OP_JUMP || op == OP_JUMP_IF_FALSE || op == OP_LOOP ||
+           op == OP_ITER_NEXT;
+}
+
+/**
+ * @brief Method to find the first live instruction at or after `index`
+ *
+ * @return int Index of the instruction, or the sentinel
+ */
+static int liveFrom(Optimizer* opt, int index) {
+    while (index < opt->count && opt->code[index].removed) index++;
+    return index;
+}
+
+/**
+ * @brief Method to find the next live instruction after `index`
+ *
+ */
+static int nextLive(Optimizer* opt, int index) {
+    return liveFrom(opt, index+1);
+}
+
+/**
+ * @brief Method to decode the chunk into the instruction array and resolve
+ * jump offsets into instruction indices.
+ *
+ */
+static void decode(VM* vm, Optimizer* opt) {
+    Chunk* chunk = opt->chunk;
+    int* indexOf = ALLOCATE(vm, int, chunk->count+1);
+
+    opt->count = 0;
+    for (int offset = 0; offset < chunk->count;
+         offset += instructionLength(chunk, offset)) {
+        indexOf[offset] = opt->count++;
+    }
+    indexOf[chunk->count] = opt->count;
+
+    opt->code = ALLOCATE(vm, Instruction, opt->count+1);
+    int index = 0;
+    for (int offset = 0; offset < chunk->count; index++) {
+        Instruction* instr = &opt->code[index];
+        instr->offset = offset;
+        instr->length = instructionLength(chunk, offset);
+        instr->target = -1;
+        instr->isTarget = false;
+        instr->removed = false;
+
+        uint8_t op = chunk->code[offset];
+        if (isJump(op)) {
+            // the jump offset is always in the last two bytes
+            int end = offset + instr->length;
+            int jump = (chunk->code[end-2] << 8) | chunk->code[end-1];
+            int dest = op == OP_LOOP ? end-jump : end+jump;
+            instr->target = indexOf[dest];
+        }
+        offset += instr->length;
+    }
+
+    // sentinel for jumps that land at the end of the chunk
+    opt->code[opt->count] = (Instruction){chunk->count, 0, -1, false, false};
+    FREE_ARRAY(vm, int, indexOf, chunk->count+1);
+}
+
+/**
+ * @brief Method to recompute which instructions are jump targets. Targets
+ * that were removed are moved to the next live instruction.
+ *
+ */
+static void markTargets(Optimizer* opt) {
+    for (int i = 0; i <= opt->count; i++) opt->code[i].isTarget = false;
+    for (int i = 0; i < opt->count; i++) {
+        Instruction* instr = &opt->code[i];
+        if (instr->removed || instr->target == -1) continue;
+        instr->target = liveFrom(opt, instr->target);
+        opt->code[instr->target].isTarget = true;
+    }
+}
+
+/**
+ * @brief Method to point jumps that land on other jumps at their final
+ * destination. Unconditional jumps onto a return become the return.
+ *
+ * @return bool True if anything changed
+ */
+static bool threadJumps(Optimizer* opt) {
+    bool changed = false;
+    for (int i = 0; i < opt->count; i++) {
+        Instruction* instr = &opt->code[i];
+        if (instr->removed || instr->target == -1) continue;
+
+        uint8_t op = opcode(opt, i);
+        int target = instr->target;
+        for (int hops = 0; hops < THREAD_MAX_HOPS && target < opt->count;
+             hops++) {
+            uint8_t landing = opcode(opt, target);
+            int next = opt->code[target].target;
+            if (next == -1 || target == i) break;
+            next = liveFrom(opt, next);
+
+            if (landing == OP_JUMP || landing == OP_LOOP) {
+                // conditional jumps can only go forward
+                if (op != OP_JUMP && op != OP_LOOP &&
+                    opt->code[next].offset <= instr->offset) break;
+                target = next;
+            } else if (op == OP_JUMP_IF_FALSE &&
+                       landing == OP_JUMP_IF_FALSE &&
+                       opt->code[next].offset > instr->offset) {
+                // the value that was falsy is still on top of the stack
+                target = next;
+            } else {
+                break;
+            }
+        }
+
+        if (target != instr->target) {
+            instr->target = target;
+            changed = true;
+        }
+        if ((op == OP_JUMP || op == OP_LOOP) && target < opt->count &&
+            opcode(opt, target) == OP_RETURN) {
+            opt->chunk->code[instr->offset] = OP_RETURN;
+            instr->length = 1;
+            instr->target = -1;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+/**
+ * @brief Method to remove instructions that can never be executed
+ *
+ * @return bool True if anything changed
+ */
+static bool removeUnreachable(VM* vm, Optimizer* opt) {
+    bool* reached = ALLOCATE(vm, bool, opt->count+1);
+    int* worklist = ALLOCATE(vm, int, opt->count+1);
+    memset(reached, 0, sizeof(bool)*(opt->count+1));
+
+    int top = 0;
+    int start = liveFrom(opt, 0);
+    if (start < opt->count) {
+        worklist[top++] = start;
+        reached[start] = true;
+    }
+    while (top > 0) {
+        int i = worklist[--top];
+        uint8_t op = opcode(opt, i);
+        int successors[2];
+        int count = 0;
+
+        if (op != OP_JUMP && op != OP_LOOP && op != OP_RETURN) {
+            successors[count++] = nextLive(opt, i);
+        }
+        if (opt->code[i].target != -1) {
+            successors[count++] = liveFrom(opt, opt->code[i].target);
+        }
+        for (int s = 0; s < count; s++) {
+            int next = successors[s];
+            if (next < opt->count && !reached[next]) {
+                reached[next] = true;
+                worklist[top++] = next;
+            }
+        }
+    }
+
+    bool changed = false;
+    for (int i = 0; i < opt->count; i++) {
+        if (!opt->code[i].removed && !reached[i]) {
+            opt->code[i].removed = true;
+            changed = true;
+        }
+    }
+    FREE_ARRAY(vm, bool, reached, opt->count+1);
+    FREE_ARRAY(vm, int, worklist, opt->count+1);
+    return changed;
+}
+
+/**
+ * @brief Method to remove jumps to the very next instruction, which do
+ * nothing
+ *
+ * @return bool True if anything changed
+ */
+static bool removeJumpsToNext(Optimizer* opt) {
+    bool changed = false;
+    for (int i = liveFrom(opt, 0); i < opt->count; i = nextLive(opt, i)) {
+        uint8_t op = opcode(opt, i);
+        if ((op == OP_JUMP || op == OP_JUMP_IF_FALSE) &&
+            opt->code[i].target == nextLive(opt, i)) {
+            opt->code[i].removed = true;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+/**
+ * @brief Method to check for instructions that only push a value and have
+ * no other effect
+ *
+ */
+static bool isPurePush(uint8_t op) {
+    switch (op) {
+        case OP_CONSTANT:
+        case OP_NULL:
+        case OP_TRUE:
+        case OP_FALSE:
+        case OP_GET_LOCAL:
+        case OP_GET_UPVALUE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Method to rewrite short instruction sequences. The instructions
+ * following the first one must not be jump targets.
+ *
+ * @return bool True if anything changed
+ */
+static bool rewritePatterns(Optimizer* opt) {
+    bool changed = false;
+    uint8_t* code = opt->chunk->code;
+
+    for (int i = liveFrom(opt, 0); i < opt->count; i = nextLive(opt, i)) {
+        Instruction* instr = &opt->code[i];
+        int j = nextLive(opt, i);
+        uint8_t op = opcode(opt, i);
+
+        if (j >= opt->count || opt->code[j].isTarget) continue;
+        uint8_t nextOp = opcode(opt, j);
+
+        switch (op) {
+            case OP_SET_LOCAL: {
+                if (nextOp != OP_POP) break;
+                int k = nextLive(opt, j);
+
+                // storing and reloading the same slot keeps the value
+                if (k < opt->count && !opt->code[k].isTarget &&
+                    opcode(opt, k) == OP_GET_LOCAL &&
+                    operand(opt, k) == operand(opt, i)) {
+                    opt->code[j].removed = true;
+                    opt->code[k].removed = true;
+                } else {
+                    code[instr->offset] = OP_SET_LOCAL_POP;
+                    opt->code[j].removed = true;
+                }
+                changed = true;
+                break;
+            }
+
+            case OP_EQUAL:
+            case OP_LESS:
+            case OP_GREATER:
+                if (nextOp != OP_NOT) break;
+                code[instr->offset] = op == OP_EQUAL ? OP_NOT_EQUAL :
+                                      op == OP_LESS  ? OP_GREATER_EQUAL :
+                                                       OP_LESS_EQUAL;
+                opt->code[j].removed = true;
+                changed = true;
+                break;
+
+            default:
+                // values pushed only to be popped again
+                if (isPurePush(op) && nextOp == OP_POP) {
+                    instr->removed = true;
+                    opt->code[j].removed = true;
+                    changed = true;
+                }
+                break;
+        }
+    }
+    return changed;
+}
+
+/**
+ * @brief Method to turn calls whose result is returned straight away into
+ * tail calls. The OP_RETURN stays behind them for callees that cannot
+ * reuse the frame, so it may still be a jump target.
+ *
+ */
+static void markTailCalls(Optimizer* opt) {
+    uint8_t* code = opt->chunk->code;
+
+    for (int i = liveFrom(opt, 0); i < opt->count; i = nextLive(opt, i)) {
+        int j = nextLive(opt, i);
+        if (j >= opt->count || opcode(opt, j) != OP_RETURN) continue;
+
+        uint8_t op = opcode(opt, i);
+        if (op == OP_CALL) code[opt->code[i].offset] = OP_TAIL_CALL;
+        if (op == OP_INVOKE) code[opt->code[i].offset] = OP_TAIL_INVOKE;
+    }
+}
+
+/**
+ * @brief Method to get the position of a binary opcode within each group of
+ * register ops
+ *
+ * @return int Offset from the first op of the group, -1 if there is none
+ */
+static int registerIndex(uint8_t op) {
+    switch (op) {
+        case OP_ADD:      return 0;
+        case OP_SUBTRACT: return 1;
+        case OP_MULTIPLY: return 2;
+        case OP_DIVIDE:   return 3;
+        case OP_LESS:     return 4;
+        case OP_GREATER:  return 5;
+        default:          return -1;
+    }
+}
+
+/**
+ * @brief Method to check for a comparison at `i` that is only used by the
+ * JUMP_IF_FALSE at `l`, with both branches popping the condition. If so, the
+ * jump and both pops are folded into instruction `i`, which takes over the
+ * jump target.
+ *
+ * @return bool True if the branch was folded
+ */
+static bool fuseBranch(Optimizer* opt, int i, int l) {
+    if (l >= opt->count || opt->code[l].isTarget ||
+        opcode(opt, l) != OP_JUMP_IF_FALSE) return false;
+    int m = nextLive(opt, l);
+    if (m >= opt->count || opt->code[m].isTarget ||
+        opcode(opt, m) != OP_POP) return false;
+    int exit = liveFrom(opt, opt->code[l].target);
+    if (exit >= opt->count || opcode(opt, exit) != OP_POP) return false;
+
+    int target = nextLive(opt, exit);
+    opt->code[i].target = target;
+    opt->code[target].isTarget = true;
+    opt->code[l].removed = true;
+    opt->code[m].removed = true;
+    return true;
+}
+
+/**
+ * @brief Method to turn stack sequences that work on locals into the
+ * register-style ops. The fused instruction is written over the bytes of
+ * the sequence it replaces, which are always at least as long.
+ *
+ */
+static void fuseRegisterOps(Optimizer* opt) {
+    uint8_t* code = opt->chunk->code;
+
+    for (int i = liveFrom(opt, 0); i < opt->count; i = nextLive(opt, i)) {
+        if (opcode(opt, i) != OP_GET_LOCAL) continue;
+        int j = nextLive(opt, i);
+        if (j >= opt->count || opt->code[j].isTarget) continue;
+        int k = nextLive(opt, j);
+        if (k >= opt->count || opt->code[k].isTarget) continue;
+
+        Instruction* instr = &opt->code[i];
+        uint8_t a = operand(opt, i);
+        uint8_t second = opcode(opt, j);
+
+        // slot++ and slot-- as statements
+        if (second == OP_INCREMENT || second == OP_DECREMENT) {
+            if (opcode(opt, k) != OP_SET_LOCAL_POP || operand(opt, k) != a) {
+                continue;
+            }
+            code[instr->offset] = second == OP_INCREMENT ?
+                                  OP_INCREMENT_LOCAL : OP_DECREMENT_LOCAL;
+            instr->length = 2;
+            opt->code[j].removed = true;
+            opt->code[k].removed = true;
+            continue;
+        }
+
+        if (second != OP_GET_LOCAL && second != OP_CONSTANT) continue;
+        int index = registerIndex(opcode(opt, k));
+        if (index == -1) continue;
+
+        bool isConstant = second == OP_CONSTANT;
+        uint8_t b = operand(opt, j);
+        int l = nextLive(opt, k);
+
+        if (index < 4 && l < opt->count && !opt->code[l].isTarget &&
+            opcode(opt, l) == OP_SET_LOCAL_POP) {
+            uint8_t dest = operand(opt, l);
+            code[instr->offset] = (isConstant ? OP_ADD_LC_SET
+                                              : OP_ADD_LL_SET) + index;
+            code[instr->offset+1] = dest;
+            code[instr->offset+2] = a;
+            code[instr->offset+3] = b;
+            instr->length = 4;
+            opt->code[l].removed = true;
+        } else if (index >= 4 && fuseBranch(opt, i, l)) {
+            // the condition of an if or loop no longer goes through the stack
+            code[instr->offset] = (isConstant ? OP_JUMP_IF_NOT_LESS_LC
+                                              : OP_JUMP_IF_NOT_LESS_LL) +
+                                  index - 4;
+            code[instr->offset+2] = b;
+            instr->length = 5;
+        } else {
+            code[instr->offset] = (isConstant ? OP_ADD_LC : OP_ADD_LL) + index;
+            code[instr->offset+2] = b;
+            instr->length = 3;
+        }
+        opt->code[j].removed = true;
+        opt->code[k].removed = true;
+    }
+}
+
+/**
+ * @brief Method to check for instructions that never fall through to the
+ * next one
+ *
+ */
+static bool endsBlock(uint8_t op) {
+    return op == OP_JUMP || op == OP_LOOP || op == OP_RETURN;
+}
+
+/**
+ * @brief Method to find the short block of code an unconditional jump at `i`
+ * lands on. The block has to end in another jump or a return, and any
+ * conditional jump inside it has to stay forward when copied to `i`.
+ *
+ * @return int Number of instructions in the block, 0 if it cannot be copied
+ */
+static int tailLength(Optimizer* opt, int i) {
+    int length = 0;
+    for (int b = liveFrom(opt, opt->code[i].target); b < opt->count;
+         b = nextLive(opt, b)) {
+        if (b == i || length == TAIL_MAX_LENGTH) return 0;
+        length++;
+
+        uint8_t op = opcode(opt, b);
+        if (endsBlock(op)) return length;
+        if (opt->code[b].target != -1 &&
+            liveFrom(opt, opt->code[b].target) <= i) return 0;
+    }
+    return 0;
+}
+
+/**
+ * @brief Method to replace unconditional jumps with a copy of the short
+ * block they land on. Loops then run as one straight path: the increment
+ * and condition of a for loop end up right after its body instead of
+ * behind two extra jumps. Copying stops once the chunk would grow past
+ * what a 16-bit jump can span. The copies share the bytes of the original,
+ * so nothing may be rewritten in place afterwards.
+ *
+ * @return bool True if anything changed
+ */
+static bool duplicateTails(VM* vm, Optimizer* opt) {
+    int size = 0;
+    for (int i = 0; i < opt->count; i++) {
+        if (!opt->code[i].removed) size += opt->code[i].length;
+    }
+
+    int* copyLength = ALLOCATE(vm, int, opt->count);
+    int grown = 0;
+    for (int i = 0; i < opt->count; i++) {
+        copyLength[i] = 0;
+        if (opt->code[i].removed) continue;
+        uint8_t op = opcode(opt, i);
+        if (op != OP_JUMP && op != OP_LOOP) continue;
+        copyLength[i] = tailLength(opt, i);
+        if (copyLength[i] == 0) continue;
+
+        // no jump can span more than the whole chunk, so keeping the chunk
+        // within a 16-bit offset keeps every jump encodable
+        int bytes = -opt->code[i].length;
+        for (int b = liveFrom(opt, opt->code[i].target), n = 0;
+             n < copyLength[i]; b = nextLive(opt, b), n++) {
+            bytes += opt->code[b].length;
+        }
+        if (size + bytes > UINT16_MAX) {
+            copyLength[i] = 0;
+            continue;
+        }
+        size += bytes;
+        grown += copyLength[i] - 1;
+    }
+    if (grown == 0) {
+        FREE_ARRAY(vm, int, copyLength, opt->count);
+        return false;
+    }
+
+    // lay out the new array, mapping old indices to new ones
+    int count = opt->count + grown;
+    int* newIndex = ALLOCATE(vm, int, opt->count+1);
+    Instruction* code = ALLOCATE(vm, Instruction, count+1);
+    int at = 0;
+    for (int i = 0; i < opt->count; i++) {
+        newIndex[i] = at;
+        if (copyLength[i] == 0) {
+            code[at++] = opt->code[i];
+            continue;
+        }
+        for (int b = liveFrom(opt, opt->code[i].target), n = 0;
+             n < copyLength[i]; b = nextLive(opt, b), n++) {
+            code[at] = opt->code[b];
+            code[at].isTarget = false;
+            at++;
+        }
+    }
+    newIndex[opt->count] = count;
+    code[count] = opt->code[opt->count];
+
+    for (int i = 0; i < count; i++) {
+        if (code[i].target != -1) code[i].target = newIndex[code[i].target];
+    }
+
+    FREE_ARRAY(vm, Instruction, opt->code, opt->count+1);
+    FREE_ARRAY(vm, int, newIndex, opt->count+1);
+    FREE_ARRAY(vm, int, copyLength, opt->count);
+    opt->code = code;
+    opt->count = count;
+    return true;
+}
+
+/**
+ * @brief Method to write the live instructions back into the chunk,
+ * relocating jumps and the line array.
+ *
+ * @return bool False if a jump would not fit in its 16-bit offset, in which
+ * case the chunk is left as it was
+ */
+static bool encode(VM* vm, Optimizer* opt) {
+    Chunk* chunk = opt->chunk;
+    int* newOffset = ALLOCATE(vm, int, opt->count+1);
+
+    int size = 0;
+    for (int i = 0; i <= opt->count; i++) {
+        newOffset[i] = size;
+        if (!opt->code[i].removed) size += opt->code[i].length;
+    }
+
+    for (int i = 0; i < opt->count; i++) {
+        Instruction* instr = &opt->code[i];
+        if (instr->removed || instr->target == -1) continue;
+        int from = newOffset[i] + instr->length;
+        int dest = newOffset[instr->target];
+        if ((dest >= from ? dest - from : from - dest) > UINT16_MAX) {
+            FREE_ARRAY(vm, int, newOffset, opt->count+1);
+            return false;
+        }
+    }
+
+    uint8_t* code = ALLOCATE(vm, uint8_t, size > 0 ? size : 1);
+    int* lines = ALLOCATE(vm, int, size > 0 ? size : 1);
+    for (int i = 0; i < opt->count; i++) {
+        Instruction* instr = &opt->code[i];
+        if (instr->removed) continue;
+
+        int at = newOffset[i];
+        memcpy(code + at, chunk->code + instr->offset, instr->length);
+        for (int b = 0; b < instr->length; b++) {
+            lines[at+b] = chunk->lines[instr->offset];
+        }
+
+        // the jump offset is always in the last two bytes
+        if (instr->target == -1) continue;
+        int from = at + instr->length;
+        int dest = newOffset[instr->target];
+        int jump;
+        if (code[at] != OP_JUMP && code[at] != OP_LOOP) {
+            jump = dest - from;
+        } else if (dest >= from) {
+            code[at] = OP_JUMP;
+            jump = dest - from;
+        } else {
+            code[at] = OP_LOOP;
+            jump = from - dest;
+        }
+        code[from-2] = (jump >> 8) & 0xff;
+        code[from-1] = jump & 0xff;
+    }
+
+    // copied blocks may have grown the code past the old arrays
+    if (size > chunk->capacity) {
+        chunk->code = GROW_ARRAY(vm, uint8_t, chunk->code, chunk->capacity,
+                                 size);
+        chunk->lines = GROW_ARRAY(vm, int, chunk->lines, chunk->capacity,
+                                  size);
+        chunk->capacity = size;
+    }
+    memcpy(chunk->code, code, size);
+    memcpy(chunk->lines, lines, sizeof(int)*size);
+    chunk->count = size;
+
+    FREE_ARRAY(vm, uint8_t, code, size > 0 ? size : 1);
+    FREE_ARRAY(vm, int, lines, size > 0 ? size : 1);
+    FREE_ARRAY(vm, int, newOffset, opt->count+1);
+    return true;
+}
+
+void optimizeChunk(VM* vm, Chunk* chunk) {
+    if (chunk->count == 0) return;
+
+    // passes rewrite the code in place, so keep the compiled code to fall
+    // back on if the result cannot be encoded
+    int count = chunk->count;
+    uint8_t* compiled = ALLOCATE(vm, uint8_t, count);
+    memcpy(compiled, chunk->code, count);
+
+    Optimizer opt;
+    opt.chunk = chunk;
+    decode(vm, &opt);
+
+    for (int pass = 0; pass < OPTIMIZE_MAX_PASSES; pass++) {
+        markTargets(&opt);
+        bool changed = threadJumps(&opt);
+        changed |= removeUnreachable(vm, &opt);
+        changed |= removeJumpsToNext(&opt);
+        markTargets(&opt);
+        changed |= rewritePatterns(&opt);
+        if (!changed) break;
+    }
+    markTailCalls(&opt);
+    if (vm->registerOps) fuseRegisterOps(&opt);
+
+    // a block copied to the end of a loop can end in another short block
+    for (int round = 0; round < TAIL_MAX_ROUNDS; round++) {
+        markTargets(&opt);
+        if (!duplicateTails(vm, &opt)) break;
+        removeUnreachable(vm, &opt);
+        markTargets(&opt);
+        removeJumpsToNext(&opt);
+    }
+    markTargets(&opt);
+
+    if (!encode(vm, &opt)) memcpy(chunk->code, compiled, count);
+    FREE_ARRAY(vm, uint8_t, compiled, count);
+    FREE_ARRAY(vm, Instruction, opt.code, opt.count+1);
+}
+
+/**
+ * @brief Method to get how many values an instruction adds to the stack
+ * once it has run, negative if it takes more than it leaves.
+ *
+ */
+static int stackEffect(Chunk* chunk, int offset) {
+    uint8_t* code = chunk->code + offset;
+    switch (code[0]) {
+        case OP_CONSTANT:
+        case OP_NULL:
+        case OP_TRUE:
+        case OP_FALSE:
+        case OP_GET_LOCAL:
+        case OP_GET_GLOBAL:
+        case OP_GET_MODULE:
+        case OP_GET_UPVALUE:
+        case OP_GET_PROPERTY_NOPOP:
+        case OP_SUBSCRIPT_IDX_NOPOP:
+        case OP_MODULE:
+        case OP_MODULE_VAR:
+        case OP_MODULE_BUILTIN:
+        case OP_ITER_INIT:
+        case OP_ITER_NEXT:
+        case OP_CLOSURE:
+        case OP_CLASS:
+        case OP_ADD_LL:
+        case OP_SUBTRACT_LL:
+        case OP_MULTIPLY_LL:
+        case OP_DIVIDE_LL:
+        case OP_LESS_LL:
+        case OP_GREATER_LL:
+        case OP_ADD_LC:
+        case OP_SUBTRACT_LC:
+        case OP_MULTIPLY_LC:
+        case OP_DIVIDE_LC:
+        case OP_LESS_LC:
+        case OP_GREATER_LC:
+            return 1;
+        case OP_POP:
+        case OP_SET_LOCAL_POP:
+        case OP_DEFINE_GLOBAL:
+        case OP_DEFINE_MODULE:
+        case OP_SUBSCRIPT_IDX:
+        case OP_SET_PROPERTY:
+        case OP_GET_SUPER:
+        case OP_EQUAL:
+        case OP_NOT_EQUAL:
+        case OP_GREATER:
+        case OP_GREATER_EQUAL:
+        case OP_LESS:
+        case OP_LESS_EQUAL:
+        case OP_ADD:
+        case OP_SUBTRACT:
+        case OP_MULTIPLY:
+        case OP_DIVIDE:
+        case OP_MOD:
+        case OP_PRINT:
+        case OP_CLOSE_UPVALUE:
+        case OP_INHERIT:
+        case OP_METHOD:
+            return -1;
+        case OP_SUBSCRIPT_ASSIGN:
+        case OP_SLICE:
+            return -2;
+        case OP_MAKE_LIST:
+            return 1 - code[1];
+        case OP_MAKE_MAP:
+            return 1 - 2*code[1];
+        case OP_CALL:
+        case OP_CALL_NATIVE:
+        case OP_TAIL_CALL:
+            return -code[1];
+        case OP_INVOKE:
+        case OP_TAIL_INVOKE:
+            return -code[2];
+        case OP_SUPER_INVOKE:
+            return -code[2] - 1;
+        default:
+            return 0;
+    }
+}
+
+int stackSize(VM* vm, Chunk* chunk, int base) {
+    // deepest stack seen on entry to each offset, -1 while not reached
+    int* depthAt = ALLOCATE(vm, int, chunk->count+1);
+    for (int offset = 0; offset <= chunk->count; offset++) {
+        depthAt[offset] = -1;
+    }
+    depthAt[0] = base;
+
+    // loop bodies are laid out after the code they jump back to, so walk
+    // the chunk again until the depths at the jump targets settle
+    int deepest = base;
+    bool changed = true;
+    for (int pass = 0; changed && pass < OPTIMIZE_MAX_PASSES; pass++) {
+        changed = false;
+        int depth = -1;
+        for (int offset = 0; offset < chunk->count;
+             offset += instructionLength(chunk, offset)) {
+            if (depthAt[offset] > depth) depth = depthAt[offset];
+            if (depth == -1) continue;
+            if (depth > deepest) deepest = depth;
+
+            uint8_t op = chunk->code[offset];
+            int end = offset + instructionLength(chunk, offset);
+            if (isJump(op) || (op >= OP_JUMP_IF_NOT_LESS_LL &&
+                               op <= OP_JUMP_IF_NOT_GREATER_LC)) {
+                // the jump offset is always in the last two bytes
+                int jump = (chunk->code[end-2] << 8) | chunk->code[end-1];
+                int dest = op == OP_LOOP ? end-jump : end+jump;
+                if (depthAt[dest] < depth) {
+                    depthAt[dest] = depth;
+                    changed |= dest <= offset;
+                }
+            }
+
+            depth += stackEffect(chunk, offset);
+            if (depth > deepest) deepest = depth;
+            if (op == OP_JUMP || op == OP_LOOP || op == OP_RETURN) depth = -1;
+        }
+    }
+
+    FREE_ARRAY(vm, int, depthAt, chunk->count+1);
+    return deepest;
+}
@@ -0,0 +1,31 @@
+#ifndef simscript_optimizer_h
+#define simscript_optimizer_h
+
+#include "chunk.h"
+
+/**
+ * @brief Method to run the peephole optimizer over a finished chunk. Does
+ * jump threading, unreachable code removal, dead push/pop removal and
+ * redundant load/store removal, and fuses common instruction pairs. Calls
+ * whose result is returned straight away become tail calls. Unless
+ * the VM runs in stack mode, arithmetic on locals is then turned into the
+ * register-style ops, with comparisons folded into the branch that uses
+ * them. Short blocks reached by a jump are finally copied in its place so
+ * that loops run as one straight path. The line array is kept in sync with
+ * the rewritten code. If a jump no longer fits in its 16-bit offset, the
+ * compiled code is kept as it was.
+ * @param chunk The chunk to optimize
+ *
+ */
+void optimizeChunk(VM* vm, Chunk* chunk);
+
+/**
+ * @brief Method to find the deepest the stack gets while running a finished
+ * chunk, counted from the first slot of its call frame.
+ * @param chunk The chunk to walk
+ * @param base Number of slots in use when the call starts
+ *
+ */
+int stackSize(VM* vm, Chunk* chunk, int base);
+
+#endif
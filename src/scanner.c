@@ -4,11 +4,46 @@
 #include "common.h"
 #include "scanner.h"
 
+/* Vectorized fast paths for the scanner. Blocks are only loaded while a whole
+ * block fits before the terminating '\0' (scanner->end); whatever is left at
+ * the end of the source is finished by the scalar loop, so no load ever reads
+ * past the buffer. Most runs in real code are short, so each fast path first
+ * checks up to SCAN_PRELUDE bytes one at a time before switching to blocks.
+ */
+#define SCAN_PRELUDE 16
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SCAN_WIDTH 32
+typedef __m256i ScanBlock;
+#define BLOCK_LOAD(p)     _mm256_loadu_si256((const __m256i*)(p))
+#define BLOCK_SPLAT(c)    _mm256_set1_epi8((char)(c))
+#define BLOCK_EQ(a, b)    _mm256_cmpeq_epi8((a), (b))
+#define BLOCK_GT(a, b)    _mm256_cmpgt_epi8((a), (b))
+#define BLOCK_AND(a, b)   _mm256_and_si256((a), (b))
+#define BLOCK_OR(a, b)    _mm256_or_si256((a), (b))
+#define BLOCK_MASK(v)     ( (uint32_t)_mm256_movemask_epi8(v) )
+#define BLOCK_BITS        ( 0xffffffffu )
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SCAN_WIDTH 16
+typedef __m128i ScanBlock;
+#define BLOCK_LOAD(p)     _mm_loadu_si128((const __m128i*)(p))
+#define BLOCK_SPLAT(c)    _mm_set1_epi8((char)(c))
+#define BLOCK_EQ(a, b)    _mm_cmpeq_epi8((a), (b))
+#define BLOCK_GT(a, b)    _mm_cmpgt_epi8((a), (b))
+#define BLOCK_AND(a, b)   _mm_and_si128((a), (b))
+#define BLOCK_OR(a, b)    _mm_or_si128((a), (b))
+#define BLOCK_MASK(v)     ( (uint32_t)_mm_movemask_epi8(v) )
+#define BLOCK_BITS        ( 0xffffu )
+#endif
+
 
 void initScanner(Scanner* scanner, const char* source) {
     // initialize both scanner pointers to the first character
     scanner->start = source;
     scanner->current = source;
+    scanner->end = source + strlen(source);
     scanner->line = 1;
     scanner->rawString = false;
 }
@@ -44,6 +79,130 @@ static bool isAtEnd(Scanner* scanner) {
     return *scanner->current == '\0';
 }
 
+#ifdef SCAN_WIDTH
+/**
+ * @brief Method to build the match mask of a block where a bit is set for
+ * every byte equal to '\0' or to one of the three given characters.
+ *
+ * @return uint32_t Match mask with bit i set for byte i of the block
+ */
+static inline uint32_t matchAny(ScanBlock block, char a, char b, char c) {
+    ScanBlock hits = BLOCK_EQ(block, BLOCK_SPLAT(0));
+    hits = BLOCK_OR(hits, BLOCK_EQ(block, BLOCK_SPLAT(a)));
+    hits = BLOCK_OR(hits, BLOCK_EQ(block, BLOCK_SPLAT(b)));
+    hits = BLOCK_OR(hits, BLOCK_EQ(block, BLOCK_SPLAT(c)));
+    return BLOCK_MASK(hits);
+}
+
+/**
+ * @brief Method to build the mask of identifier characters ([A-Za-z0-9_])
+ * in a block. Bytes above 0x7f are negative as signed chars and never match.
+ *
+ * @return uint32_t Mask with bit i set if byte i is an identifier character
+ */
+static inline uint32_t matchIdentifier(ScanBlock block) {
+    ScanBlock lower = BLOCK_OR(block, BLOCK_SPLAT(0x20));
+    ScanBlock alpha = BLOCK_AND(BLOCK_GT(lower, BLOCK_SPLAT('a' - 1)),
+                                BLOCK_GT(BLOCK_SPLAT('z' + 1), lower));
+    ScanBlock digit = BLOCK_AND(BLOCK_GT(block, BLOCK_SPLAT('0' - 1)),
+                                BLOCK_GT(BLOCK_SPLAT('9' + 1), block));
+    ScanBlock under = BLOCK_EQ(block, BLOCK_SPLAT('_'));
+    return BLOCK_MASK(BLOCK_OR(BLOCK_OR(alpha, digit), under));
+}
+#endif
+
+/**
+ * @brief Method to find the first occurrence of '\0' or any of the three given
+ * characters, starting at (and including) the given position.
+ *
+ * @param end Pointer to the terminating '\0' of the source
+ * @return const char* Pointer to the first matching character
+ */
+static inline const char* findAny(const char* p, const char* end,
+                                  char a, char b, char c) {
+    for (int i = 0; i < SCAN_PRELUDE; i++, p++) {
+        if (*p == '\0' || *p == a || *p == b || *p == c) return p;
+    }
+#ifdef SCAN_WIDTH
+    for (; end - p >= SCAN_WIDTH; p += SCAN_WIDTH) {
+        uint32_t mask = matchAny(BLOCK_LOAD(p), a, b, c);
+        if (mask != 0) return p + __builtin_ctz(mask);
+    }
+#else
+    (void)end;
+#endif
+    while (*p != '\0' && *p != a && *p != b && *p != c) p++;
+    return p;
+}
+
+/**
+ * @brief Method to skip a run of identifier characters
+ *
+ * @param end Pointer to the terminating '\0' of the source
+ * @return const char* Pointer to the first non-identifier character
+ */
+static inline const char* skipIdentifier(const char* p, const char* end) {
+    for (int i = 0; i < SCAN_PRELUDE; i++, p++) {
+        if (!isAlpha(*p) && !isDigit(*p)) return p;
+    }
+#ifdef SCAN_WIDTH
+    for (; end - p >= SCAN_WIDTH; p += SCAN_WIDTH) {
+        uint32_t mask = ~matchIdentifier(BLOCK_LOAD(p)) & BLOCK_BITS;
+        if (mask != 0) return p + __builtin_ctz(mask);
+    }
+#else
+    (void)end;
+#endif
+    while (isAlpha(*p) || isDigit(*p)) p++;
+    return p;
+}
+
+/**
+ * @brief Method to skip a run of blank characters (' ', '\t', '\r', '\n'),
+ * counting the newlines that were skipped over.
+ *
+ * @param end Pointer to the terminating '\0' of the source
+ * @param lines Incremented by the number of newlines skipped
+ * @return const char* Pointer to the first non-blank character
+ */
+static inline const char* skipBlanks(const char* p, const char* end,
+                                     int* lines) {
+    for (int i = 0; i < SCAN_PRELUDE; i++, p++) {
+        if (*p == '\n') {
+            (*lines)++;
+        } else if (*p != ' ' && *p != '\t' && *p != '\r') {
+            return p;
+        }
+    }
+#ifdef SCAN_WIDTH
+    ScanBlock newline = BLOCK_SPLAT('\n');
+    for (; end - p >= SCAN_WIDTH; p += SCAN_WIDTH) {
+        ScanBlock bytes = BLOCK_LOAD(p);
+        uint32_t newlines = BLOCK_MASK(BLOCK_EQ(bytes, newline));
+        uint32_t blanks = newlines | BLOCK_MASK(BLOCK_OR(
+                              BLOCK_OR(BLOCK_EQ(bytes, BLOCK_SPLAT(' ')),
+                                       BLOCK_EQ(bytes, BLOCK_SPLAT('\t'))),
+                              BLOCK_EQ(bytes, BLOCK_SPLAT('\r'))));
+        uint32_t stop = ~blanks & BLOCK_BITS;
+        if (stop != 0) {
+            int at = __builtin_ctz(stop);
+            *lines += __builtin_popcount(newlines & (uint32_t)((1ull << at) - 1));
+            return p + at;
+        }
+        *lines += __builtin_popcount(newlines);
+    }
+#else
+    (void)end;
+#endif
+    for (;; p++) {
+        if (*p == '\n') {
+            (*lines)++;
+        } else if (*p != ' ' && *p != '\t' && *p != '\r') {
+            return p;
+        }
+    }
+}
+
 /** 
  * @brief Method to read the next character and advance scanner.current.
  * 
@@ -125,30 +284,34 @@ static void skipWhiteSpace(Scanner* scanner) {
     for (;;) {
         char c = peek(scanner);
         switch (c) {
+            // whitespace runs are skipped in bulk, counting the newlines
             case ' ':
             case '\r':
             case '\t':
-                advance(scanner);
-                break;
-
-            // for a newline, increment the line number
             case '\n':
-                scanner->line++;
-                advance(scanner);
+                scanner->current = skipBlanks(scanner->current, scanner->end,
+                                              &scanner->line);
                 break;
 
             // Comments signals ignore the line until the next newline
             case '/':
                 if (peekNext(scanner) == '/') {
-                    while ( peek(scanner) != '\n' && !isAtEnd(scanner) ) advance(scanner);
+                    scanner->current = findAny(scanner->current, scanner->end,
+                                               '\n', '\n', '\n');
                 } else if (peekNext(scanner) == '*') {
                     advance(scanner);
                     advance(scanner);
                     while ( !isAtEnd(scanner) ) {
-                        if (peek(scanner) == '*' && peekNext(scanner) == '/') {
+                        scanner->current = findAny(scanner->current, scanner->end,
+                                                   '*', '\n', '\n');
+                        if (peek(scanner) == '\n') {
+                            scanner->line++;
+                        } else if (peek(scanner) == '*' && peekNext(scanner) == '/') {
                             advance(scanner);
                             advance(scanner);
                             break;
+                        } else if (isAtEnd(scanner)) {
+                            break;
                         }
                         advance(scanner);
                     }
@@ -170,23 +333,51 @@ static void skipWhiteSpace(Scanner* scanner) {
 }
 
 /**
- * @brief Method to check if the current identifier is a keyword.
- * @param start Index at which the identifier starts
- * @param length The length of the identifier
- * @param rest The remainder of the keyword after the first letter
- * @param type Type of token to return based on keyword
+ * @brief Single entry of the keyword table.
  *
- * @return Tokentype The corresponding Tokentype for the identifier token.
- * Returns TOKEN_IDENTIFIER if no matches occur.
  */
-static Tokentype checkKeyword(Scanner* scanner, int start, int length,
-        const char* rest, Tokentype type) {
-    if (scanner->current - scanner->start == start + length &&
-        memcmp(scanner->start + start, rest, length) == 0) {
-        return type;
-    }
-    return TOKEN_IDENTIFIER;
-}
+typedef struct {
+    const char* name;
+    int length;
+    Tokentype type;
+} Keyword;
+
+/**
+ * @brief Perfect hash over the keyword set. Every keyword lands in its own
+ * slot, so classifying an identifier costs one lookup and one memcmp.
+ * Re-check the table for collisions when adding a keyword.
+ */
+#define KEYWORD_SLOTS 64
+#define KEYWORD_HASH(first, last, length) \
+    (((unsigned)(first) + 2u*(unsigned)(last) + 26u*(unsigned)(length)) \
+     & (KEYWORD_SLOTS-1))
+
+static const Keyword keywords[KEYWORD_SLOTS] = {
+    [ 1] = {"extends",  7, TOKEN_INHERIT},
+    [ 2] = {"this",     4, TOKEN_THIS},
+    [ 3] = {"while",    5, TOKEN_WHILE},
+    [ 5] = {"using",    5, TOKEN_USING},
+    [ 6] = {"local",    5, TOKEN_LOCAL},
+    [ 7] = {"or",       2, TOKEN_OR},
+    [11] = {"class",    5, TOKEN_CLASS},
+    [13] = {"const",    5, TOKEN_CONST},
+    [18] = {"function", 8, TOKEN_FUN},
+    [19] = {"module",   6, TOKEN_MODULE},
+    [23] = {"else",     4, TOKEN_ELSE},
+    [24] = {"for",      3, TOKEN_FOR},
+    [25] = {"super",    5, TOKEN_SUPER},
+    [38] = {"true",     4, TOKEN_TRUE},
+    [40] = {"var",      3, TOKEN_VAR},
+    [41] = {"if",       2, TOKEN_IF},
+    [42] = {"return",   6, TOKEN_RETURN},
+    [43] = {"echo",     4, TOKEN_PRINT},
+    [46] = {"null",     4, TOKEN_NULL},
+    [50] = {"false",    5, TOKEN_FALSE},
+    [55] = {"and",      3, TOKEN_AND},
+    [58] = {"break",    5, TOKEN_BREAK},
+    [59] = {"as",       2, TOKEN_AS},
+    [61] = {"continue", 8, TOKEN_CONTINUE},
+};
 
 /**
  * @brief Method to return the correct identifier type
@@ -194,80 +385,22 @@ static Tokentype checkKeyword(Scanner* scanner, int start, int length,
  * @return Tokentype identifier token type
  */
 static Tokentype identifierType(Scanner* scanner) {
+    int length = (int)(scanner->current - scanner->start);
 
-    switch (scanner->start[0]) {
-        case 'a':
-            if (scanner->current-scanner->start > 1) {
-                switch (scanner->start[1]) {
-                    case 's': return checkKeyword(scanner, 2,0, "", TOKEN_AS);
-                    case 'n': return checkKeyword(scanner, 2,1, "d", TOKEN_AND);
-                }
-            }
-            break;
-        case 'b': return checkKeyword(scanner, 1, 4, "reak", TOKEN_BREAK);
-        case 'c':
-            if (scanner->current-scanner->start > 1) {
-                switch (scanner->start[1]) {
-                    case 'l': return checkKeyword(scanner, 2,3, "ass", TOKEN_CLASS);
-                    case 'o':
-                        if (scanner->current-scanner->start > 3) {
-                            switch (scanner->start[3]) {
-                                case 's':
-                                    return checkKeyword(scanner, 4,1, "t", TOKEN_CONST);
-                                case 't':
-                                    return checkKeyword(scanner, 4,4, "inue", TOKEN_CONTINUE);
-                            }
-                        }
-                }
-            }
-            break;
-        case 'e':
-            if (scanner->current-scanner->start > 1) {
-              switch (scanner->start[1]) {
-                  case 'l': return checkKeyword(scanner, 2,2, "se", TOKEN_ELSE);
-                  case 'x': return checkKeyword(scanner, 2,5, "tends", TOKEN_INHERIT);
-                  case 'c': return checkKeyword(scanner, 2,2, "ho", TOKEN_PRINT);
-              }
-            }
-            break;
-        case 'f':
-            if (scanner->current-scanner->start > 1) {
-              switch (scanner->start[1]) {
-                  case 'a': return checkKeyword(scanner, 2,3, "lse", TOKEN_FALSE);
-                  case 'o': return checkKeyword(scanner, 2,1, "r", TOKEN_FOR);
-                  case 'u': return checkKeyword(scanner, 2,6, "nction", TOKEN_FUN);
-              }
-            }
-            break;
-        case 'i': return checkKeyword(scanner, 1, 1, "f", TOKEN_IF);
-        case 'l': return checkKeyword(scanner, 1, 4, "ocal", TOKEN_LOCAL);
-        case 'm': return checkKeyword(scanner, 1, 5, "odule", TOKEN_MODULE);
-        case 'n': return checkKeyword(scanner, 1, 3, "ull", TOKEN_NULL);
-        case 'o': return checkKeyword(scanner, 1, 1, "r", TOKEN_OR);
-        case 'r':
-                  if (scanner->current-scanner->start > 1) {
-                      switch(scanner->start[1]) {
-                          case 'e': return checkKeyword(scanner, 2, 4, "turn", TOKEN_RETURN);
-                      }
-                  } else {
-                      if (scanner->start[1] == '"' || scanner->start[1] == '\'') {
-                          scanner->rawString = true;
-                          return TOKEN_RSTRING;
-                      }
-                  }
-                  break;
-        case 's': return checkKeyword(scanner, 1, 4, "uper", TOKEN_SUPER);
-        case 't':
-            if (scanner->current-scanner->start > 1) {
-              switch (scanner->start[1]) {
-                  case 'h': return checkKeyword(scanner, 2,2, "is", TOKEN_THIS);
-                  case 'r': return checkKeyword(scanner, 2,2, "ue", TOKEN_TRUE);
-              }
-            }
-            break;
-        case 'u': return checkKeyword(scanner, 1, 4, "sing", TOKEN_USING);
-        case 'v': return checkKeyword(scanner, 1, 2, "ar", TOKEN_VAR);
-        case 'w': return checkKeyword(scanner, 1, 4, "hile", TOKEN_WHILE);
+    // raw string prefix r"..." / r'...'
+    if (length == 1 && scanner->start[0] == 'r' &&
+        (scanner->start[1] == '"' || scanner->start[1] == '\'')) {
+        scanner->rawString = true;
+        return TOKEN_RSTRING;
+    }
+    if (length < 2 || length > 8) return TOKEN_IDENTIFIER;
+
+    const Keyword* keyword = &keywords[KEYWORD_HASH(
+            (unsigned char)scanner->start[0],
+            (unsigned char)scanner->start[length-1], length)];
+    if (keyword->length == length &&
+        memcmp(scanner->start, keyword->name, length) == 0) {
+        return keyword->type;
     }
     return TOKEN_IDENTIFIER;
 }
@@ -278,7 +411,7 @@ static Tokentype identifierType(Scanner* scanner) {
  * @return Token Token of type TOKEN_IDENTIFIER.
  */
 static Token identifier(Scanner* scanner) {
-    while ( isAlpha(peek(scanner)) || isDigit(peek(scanner)) ) advance(scanner);
+    scanner->current = skipIdentifier(scanner->current, scanner->end);
     return makeToken(scanner, identifierType(scanner));
 }
 
@@ -307,11 +440,20 @@ static Token number(Scanner* scanner) {
  * string is unterminated.
  */
 static Token string(Scanner* scanner, char termChar) {
-    while (peek(scanner) != termChar && !isAtEnd(scanner)) {
+    for (;;) {
+        // jump straight to the next character that needs attention
+        scanner->current = findAny(scanner->current, scanner->end,
+                                   termChar, '\n', '\\');
+        if (peek(scanner) == termChar || isAtEnd(scanner)) break;
+
         // multiline string support
         if (peek(scanner) == '\n') {
             scanner->line++;
         } else if (peek(scanner) == '\\' && !scanner->rawString) {
+            if (peekNext(scanner) == '\0') {
+                advance(scanner);
+                break;
+            }
             scanner->current++;
         }
         advance(scanner);
@@ -41,6 +41,7 @@ typedef enum {
 typedef struct {
     const char* start;
     const char* current;
+    const char* end;
     int line;
     bool rawString;
 } Scanner;
@@ -176,3 +176,173 @@ void markTable(VM* vm, Table* table) {
         markValue(vm, entry->value);
     }
 }
+
+void initValueTable(ValueTable* table) {
+    table->count = 0;
+    table->live = 0;
+    table->capacity = 0;
+    table->entries = NULL;
+}
+
+void freeValueTable(VM* vm, ValueTable* table) {
+    FREE_ARRAY(vm, ValueEntry, table->entries, table->capacity);
+    initValueTable(table);
+}
+
+/**
+ * @brief Method to scramble the bits of a key, so that keys that differ
+ * only in their high bits, like doubles or pointers, spread over the table
+ *
+ */
+static uint32_t mixBits(uint64_t bits) {
+    bits ^= bits >> 33;
+    bits *= 0xff51afd7ed558ccdULL;
+    bits ^= bits >> 33;
+    return (uint32_t)bits;
+}
+
+/**
+ * @brief Method to hash a key consistently with keysEqual
+ *
+ */
+static uint32_t hashValue(Value key) {
+    if (IS_STRING(key)) return AS_STRING(key)->hash;
+    if (IS_NUMBER(key)) {
+        // ints and doubles of the same value, and 0 and -0, hash alike
+        double number = AS_NUMBER(key);
+        if (number == 0) number = 0;
+        uint64_t bits;
+        memcpy(&bits, &number, sizeof(bits));
+        return mixBits(bits);
+    }
+    if (IS_OBJ(key)) return mixBits((uint64_t)(uintptr_t)AS_OBJ(key));
+    return AS_BOOL(key) ? 1 : 2;
+}
+
+/**
+ * @brief Method to compare keys. Unlike valuesEqual, lists and other
+ * objects are only the same key if they are the same object.
+ *
+ */
+static bool keysEqual(Value a, Value b) {
+    if (IS_OBJ(a) || IS_OBJ(b)) {
+        return IS_OBJ(a) && IS_OBJ(b) && AS_OBJ(a) == AS_OBJ(b);
+    }
+    return valuesEqual(a, b);
+}
+
+/**
+ * @brief Method to find the entry of a key, or where it would go
+ *
+ * @param entries Array of ValueEntry structs to loop through
+ * @param capacity The capacity of the current hashmap
+ * @param key Target key
+ * @return ValueEntry* Entry with a null key if the key doesn't exist
+ */
+static ValueEntry* findValueEntry(ValueEntry* entries, int capacity,
+                                  Value key) {
+    uint32_t index = hashValue(key) & (capacity-1);
+    ValueEntry* tombstone = NULL;
+
+    for (;;) {
+        ValueEntry* entry = &entries[index];
+        if (IS_NULL(entry->key)) {
+            if (IS_NULL(entry->value)) {
+                return tombstone != NULL ? tombstone : entry;
+            } else {
+                if (tombstone == NULL) tombstone = entry;
+            }
+        } else if (keysEqual(entry->key, key)) {
+            return entry;
+        }
+        index = (index + 1) & (capacity - 1);
+    }
+}
+
+bool valueTableGet(ValueTable* table, Value key, Value* value) {
+    if (table->count == 0) return false;
+
+    ValueEntry* entry = findValueEntry(table->entries, table->capacity, key);
+    if (IS_NULL(entry->key)) return false;
+
+    *value = entry->value;
+    return true;
+}
+
+/**
+ * @brief Method to adjust the capacity of a ValueTable
+ *
+ * @param table Table to adjust the capacity
+ * @param capacity Target capacity
+ */
+static void adjustValueCapacity(VM* vm, ValueTable* table, int capacity) {
+    ValueEntry* entries = ALLOCATE(vm, ValueEntry, capacity);
+    for (int i = 0; i < capacity; i++) {
+        entries[i].key = NULL_VAL;
+        entries[i].value = NULL_VAL;
+    }
+
+    // tombstones are dropped, so count goes back to the number of keys
+    table->count = 0;
+    for (int i = 0; i < table->capacity; i++) {
+        ValueEntry* entry = &table->entries[i];
+        if (IS_NULL(entry->key)) continue;
+
+        ValueEntry* dest = findValueEntry(entries, capacity, entry->key);
+        dest->key = entry->key;
+        dest->value = entry->value;
+        table->count++;
+    }
+
+    FREE_ARRAY(vm, ValueEntry, table->entries, table->capacity);
+    table->entries = entries;
+    table->capacity = capacity;
+}
+
+bool valueTableSet(VM* vm, ValueTable* table, Value key, Value value) {
+    if (table->count+1 > table->capacity * TABLE_MAX_LOAD) {
+        int capacity = GROW_CAPACITY(table->capacity);
+        adjustValueCapacity(vm, table, capacity);
+    }
+    ValueEntry* entry = findValueEntry(table->entries, table->capacity, key);
+
+    bool isNewKey = IS_NULL(entry->key);
+    if (isNewKey) {
+        if (IS_NULL(entry->value)) table->count++;
+        table->live++;
+    }
+
+    entry->key = key;
+    entry->value = value;
+    return isNewKey;
+}
+
+bool valueTableDelete(ValueTable* table, Value key) {
+    if (table->count == 0) return false;
+
+    ValueEntry* entry = findValueEntry(table->entries, table->capacity, key);
+    if (IS_NULL(entry->key)) return false;
+
+    // leaving a tombstone so that probing goes on past this entry
+    entry->key = NULL_VAL;
+    entry->value = BOOL_VAL(true);
+    table->live--;
+    return true;
+}
+
+void valueTableAddAll(VM* vm, ValueTable* from, ValueTable* to) {
+    for (int i = 0; i < from->capacity; i++) {
+        ValueEntry* entry = &from->entries[i];
+        if (!IS_NULL(entry->key)) {
+            valueTableSet(vm, to, entry->key, entry->value);
+        }
+    }
+}
+
+void markValueTable(VM* vm, ValueTable* table) {
+    for (int i = 0; i < table->capacity; i++) {
+        ValueEntry* entry = &table->entries[i];
+        markValue(vm, entry->key);
+        markValue(vm, entry->value);
+    }
+}
@@ -22,6 +22,27 @@ typedef struct {
     Entry* entries;
 } Table;
 
+/**
+ * @brief Struct to define an entry in a hash table keyed by values
+ */
+typedef struct {
+    Value key;
+    Value value;
+} ValueEntry;
+
+/**
+ * @brief Struct to define a hash table with keys of any type but null.
+ * Numbers are keys by value, strings by contents, since they are interned,
+ * and other objects by identity. `count` includes tombstones, like in
+ * Table, while `live` is the number of keys.
+ */
+typedef struct {
+    int count;
+    int live;
+    int capacity;
+    ValueEntry* entries;
+} ValueTable;
+
 /**
  * @brief Table constructor
  *
@@ -99,4 +120,62 @@ void tableRemoveWhite(VM* vm, Table* table);
  */
 void markTable(VM* vm, Table* table);
 
+/**
+ * @brief ValueTable constructor
+ *
+ * @param table A pointer to a table struct
+ */
+void initValueTable(ValueTable* table);
+
+/**
+ * @brief Method to free a ValueTable
+ *
+ * @param table The pointer to the table to free
+ */
+void freeValueTable(VM* vm, ValueTable* table);
+
+/**
+ * @brief Method to get a value from a ValueTable given a key
+ *
+ * @param table Table to perform the lookup
+ * @param key The key to get the value from, not null
+ * @param value The pointer to the value that will hold the value
+ * @return True if value exists
+ */
+bool valueTableGet(ValueTable* table, Value key, Value* value);
+
+/**
+ * @brief Method to add the given key-value pair to a ValueTable
+ *
+ * @param table Table to hold the key-value pair
+ * @param key Key to call value, not null
+ * @param value Value called by key
+ * @return True if a new entry was added
+ */
+bool valueTableSet(VM* vm, ValueTable* table, Value key, Value value);
+
+/**
+ * @brief Method to delete a key from a ValueTable
+ *
+ * @param table Table to delete the key from
+ * @param key The key to delete
+ * @return True if key existed
+ */
+bool valueTableDelete(ValueTable* table, Value key);
+
+/**
+ * @brief Method to copy all the entries of one ValueTable to another
+ *
+ * @param from Table to copy entries from
+ * @param to Table to copy entries to
+ */
+void valueTableAddAll(VM* vm, ValueTable* from, ValueTable* to);
+
+/**
+ * @brief Method to mark the keys and values of a ValueTable
+ *
+ * @param table The table to mark
+ */
+void markValueTable(VM* vm, ValueTable* table);
+
 #endif
@@ -62,7 +62,39 @@ static bool compareObj(Value a, Value b) {
             if (list1->items.count != list2->items.count)
                 return false;
             for (int i = 0; i<list1->items.count; i++) {
-                if (list1->items.values[i] != list2->items.values[i])
+                Value x = list1->items.values[i];
+                Value y = list2->items.values[i];
+                // ints and doubles holding the same number are equal
+                if (IS_NUMBER(x) && IS_NUMBER(y) ?
+                    AS_NUMBER(x) != AS_NUMBER(y) : x != y)
+                    return false;
+            }
+            return true;
+        }
+        case OBJ_ARRAY: {
+            ObjArray* array1 = AS_ARRAY(a);
+            ObjArray* array2 = AS_ARRAY(b);
+            if (array1->count != array2->count)
+                return false;
+            for (int i = 0; i<array1->count; i++) {
+                if (array1->values[i] != array2->values[i])
+                    return false;
+            }
+            return true;
+        }
+        case OBJ_MAP:
+        case OBJ_SET: {
+            // sets store true for every key, so they compare like maps
+            ValueTable* table1 = &AS_MAP(a)->table;
+            ValueTable* table2 = &AS_MAP(b)->table;
+            if (table1->live != table2->live)
+                return false;
+            for (int i = 0; i<table1->capacity; i++) {
+                ValueEntry* entry = &table1->entries[i];
+                if (IS_NULL(entry->key)) continue;
+                Value other;
+                if (!valueTableGet(table2, entry->key, &other) ||
+                    !valuesEqual(entry->value, other))
                     return false;
             }
             return true;
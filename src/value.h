@@ -25,6 +25,7 @@ typedef uint64_t Value;
 
 #define SIGN_BIT            ( (uint64_t)0x8000000000000000 )
 #define QNAN                ( (uint64_t)0x7ffc000000000000 )
+#define INT_BIT             ( (uint64_t)0x0001000000000000 )
 
 #define TAG_BAD  0
 #define TAG_NULL  1
@@ -34,12 +35,18 @@ typedef uint64_t Value;
 #define IS_BAD(value)      ( (value) == BAD_VAL )
 #define IS_BOOL(value)      ( ((value) | 1) == TRUE_VAL)
 #define IS_NULL(value)      ( (value) == NULL_VAL )
-#define IS_NUMBER(value)    ( ((value) & QNAN) != QNAN )
+#define IS_DOUBLE(value)    ( ((value) & QNAN) != QNAN )
+#define IS_INT(value) \
+    ( ((value) & (SIGN_BIT | QNAN | INT_BIT)) == (QNAN | INT_BIT) )
+#define IS_NUMBER(value)    ( IS_DOUBLE(value) || IS_INT(value) )
 #define IS_OBJ(value) \
     ( ((value) & (QNAN | SIGN_BIT)) == (QNAN | SIGN_BIT) )
 
 #define AS_BOOL(value)      ( (value) == TRUE_VAL )
+#define AS_DOUBLE(value)    rawToNum(value)
+#define AS_INT(value)       ( (int32_t)(uint32_t)(value) )
 #define AS_NUMBER(value)    valueToNum(value)
+#define AS_INTEGER(value)   valueToInt(value)
 #define AS_OBJ(value) \
     ( (Obj*)(uintptr_t)((value) & ~(SIGN_BIT | QNAN)) )
 
@@ -49,21 +56,64 @@ typedef uint64_t Value;
 #define FALSE_VAL           ( (Value)(uint64_t)(QNAN | TAG_FALSE) )
 #define NULL_VAL            ( (Value)(uint64_t)(QNAN | TAG_NULL) )
 #define NUMBER_VAL(num)     numToValue(num)
+#define INT_VAL(num) \
+    ( (Value)(QNAN | INT_BIT | (uint64_t)(uint32_t)(num)) )
 #define OBJ_VAL(obj) \
     (Value)(SIGN_BIT | QNAN | (uint64_t)(uintptr_t)(obj))
 
-static inline double valueToNum(Value value) {
+static inline double rawToNum(Value value) {
     double num;
     memcpy(&num, &value, sizeof(Value));
     return num;
 }
 
+static inline double valueToNum(Value value) {
+    if (IS_INT(value)) return (double)AS_INT(value);
+    return rawToNum(value);
+}
+
+static inline int valueToInt(Value value) {
+    if (IS_INT(value)) return AS_INT(value);
+    return (int)rawToNum(value);
+}
+
 static inline Value numToValue(double num) {
     Value value;
     memcpy(&value, &num, sizeof(double));
     return value;
 }
 
+/**
+ * @brief Method to box the result of integer arithmetic. Results that do
+ * not fit in 32 bits are promoted to doubles.
+ *
+ */
+static inline Value intToValue(int64_t num) {
+    if (num == (int32_t)num) return INT_VAL(num);
+    return numToValue((double)num);
+}
+
+/**
+ * @brief Method to box the product of two ints. A zero product with a
+ * negative factor is -0 in floating point, which ints cannot hold, so it
+ * is kept as a double.
+ *
+ */
+static inline Value intProduct(int64_t x, int64_t y) {
+    if ((x == 0 || y == 0) && (x < 0 || y < 0)) return numToValue(-0.0);
+    return intToValue(x * y);
+}
+
+/**
+ * @brief Method to box the negation of an int. Negating 0 gives -0, which
+ * is kept as a double.
+ *
+ */
+static inline Value intNegation(int64_t x) {
+    if (x == 0) return numToValue(-0.0);
+    return intToValue(-x);
+}
+
 #else
 
 /**
@@ -99,6 +149,10 @@ typedef struct {
 #define IS_NUMBER(value) ( (value).type == VAL_NUMBER )
 #define IS_OBJ(value)    ( (value).type == VAL_OBJ )
 
+// all numbers are doubles without NaN boxing
+#define IS_DOUBLE(value) IS_NUMBER(value)
+#define IS_INT(value)    ( (void)(value), false )
+
 /**
  * @brief Unpacking the values into the C values
  *
@@ -106,6 +160,9 @@ typedef struct {
 #define AS_BOOL(value) ( (value).as.boolean )
 #define AS_NUMBER(value) ( (value).as.number )
 #define AS_OBJ(value) ( (value).as.obj )
+#define AS_DOUBLE(value) AS_NUMBER(value)
+#define AS_INT(value) ( (int32_t)(value).as.number )
+#define AS_INTEGER(value) ( (int)(value).as.number )
 
 /**
  * @brief Converting a native C value into the language
@@ -115,6 +172,10 @@ typedef struct {
 #define NULL_VAL          ( (Value){VAL_NULL, {.number = 0}} )
 #define NUMBER_VAL(value) ( (Value){VAL_NUMBER, {.number = value}} )
 #define OBJ_VAL(object)   ( (Value){VAL_OBJ, {.obj = (Obj*)object}} )
+#define INT_VAL(value)    NUMBER_VAL((double)(value))
+#define intToValue(value) NUMBER_VAL((double)(value))
+#define intProduct(x, y)  NUMBER_VAL((double)(x) * (double)(y))
+#define intNegation(x)    NUMBER_VAL(-(double)(x))
 
 #endif // for NAN_BOXING
 
@@ -134,6 +195,16 @@ typedef struct {
  */
 bool valuesEqual(Value a, Value b);
 
+/**
+ * @brief Method to determine if a value is "falsey"
+ *
+ * @param value Value to check false-ness
+ * @return True if value is falsey
+ */
+static inline bool isFalsey(Value value) {
+    return IS_NULL(value) || (IS_BOOL(value) && !AS_BOOL(value));
+}
+
 /**
  * @brief Method to initialize the value array
  * @param array Pointer to value array
@@ -9,6 +9,7 @@
 #include "table.h"
 #include "vm.h"
 #include "chunk.h"
+#include "debug.h"
 #include "common.h"
 #include "memory.h"
 #include "natives.h"
@@ -16,9 +17,16 @@
 #include "read.h"
 #include "value.h"
 
+#include "objs/array.h"
 #include "objs/list.h"
+#include "objs/map.h"
+#include "objs/range.h"
+#include "objs/set.h"
 #include "objs/string.h"
 
+#define TRACE_INNER 16 // innermost calls shown in a stack trace
+#define TRACE_OUTER 4  // outermost calls shown in a stack trace
+
 /**
  * @brief Global vm instance to be referred to by all the methods. 
  * May later be an argument to each of the functions.
@@ -32,10 +40,38 @@ static void resetStack(VM* vm) {
     // setting the stackTop pointer to the beginning of the stack
     vm->stackTop = vm->stack;
     vm->frameCount = 0;
-    vm->openUpvalues = NULL;
+    memset(vm->openUpvalues, 0, sizeof(ObjUpvalue*) * vm->openTop);
+    vm->openTop = 0;
     vm->compiler = NULL;
 }
 
+/**
+ * @brief Method to print the call stack, innermost frame first. Deep stacks
+ * only show the frames at both ends.
+ *
+ */
+static void printStackTrace(VM* vm) {
+    for (int i = vm->frameCount-1; i>=0; i--) {
+        int shown = vm->frameCount-1 - i;
+        if (shown == TRACE_INNER && i > TRACE_OUTER) {
+            fprintf(stderr, "  ... %d more calls\n", i - TRACE_OUTER + 1);
+            i = TRACE_OUTER - 1;
+        }
+        CallFrame* frame = &vm->frames[i];
+        ObjFunction* function = frame->closure->function;
+        size_t instruction = frame->ip - function->chunk.code - 1;
+
+        fprintf(stderr, "  @ '%s', line %d in ",
+                function->module->name->chars,
+                function->chunk.lines[instruction]);
+        if (function->name == NULL) {
+            fprintf(stderr, "top-level script\n\n");
+        } else{
+            fprintf(stderr, "\033[1;36m%s()\033[0m\n", function->name->chars);
+        }
+    }
+}
+
 /**
  * @brief Method to handle runtime errors
  * @param format The print format for error messaging
@@ -57,20 +93,7 @@ void runtimeError(VM* vm, const char* format, ...) {
      * set vm.frameCount-1 since we want the stack trace to point to the 
      * previous failed instruction
      */
-    for (int i = vm->frameCount-1; i>=0; i--) {
-        CallFrame* frame = &vm->frames[i];
-        ObjFunction* function = frame->closure->function;
-        size_t instruction = frame->ip - function->chunk.code - 1;
-
-        fprintf(stderr, "  @ '%s', line %d in ",
-                function->module->name->chars,
-                function->chunk.lines[instruction]);
-        if (function->name == NULL) {
-            fprintf(stderr, "top-level script\n\n");
-        } else{
-            fprintf(stderr, "\033[1;36m%s()\033[0m\n", function->name->chars);
-        }
-    }
+    printStackTrace(vm);
     resetStack(vm);
 }
 
@@ -86,26 +109,24 @@ void runtimeWarning(VM* vm, const char* format, ...) {
     va_end(args);
     fputs("\n", stderr);
 
-    for (int i = vm->frameCount-1; i>=0; i--) {
-        CallFrame* frame = &vm->frames[i];
-        ObjFunction* function = frame->closure->function;
-        size_t instruction = frame->ip - function->chunk.code - 1;
-
-        fprintf(stderr, "  @ '%s', line %d in ",
-                function->module->name->chars,
-                function->chunk.lines[instruction]);
-        if (function->name == NULL) {
-            fprintf(stderr, "top-level script\n\n");
-        } else{
-            fprintf(stderr, "\033[1;36m%s()\033[0m\n", function->name->chars);
-        }
-    }
+    printStackTrace(vm);
 }
 
 VM* initVM(bool repl) {
     VM* vm = (VM*)malloc(sizeof(VM));
+    vm->stackCapacity = STACK_MIN;
+    vm->stack = (Value*)malloc(sizeof(Value) * vm->stackCapacity);
+    vm->frameCapacity = FRAMES_MIN;
+    vm->frames = (CallFrame*)malloc(sizeof(CallFrame) * vm->frameCapacity);
+    vm->openUpvalues = (ObjUpvalue**)calloc(vm->stackCapacity,
+                                            sizeof(ObjUpvalue*));
+    if (vm->stack == NULL || vm->frames == NULL || vm->openUpvalues == NULL) {
+        exit(1);
+    }
+    vm->openTop = 0;
     resetStack(vm);
     vm->repl = repl;
+    vm->registerOps = true;
     vm->objects = NULL;
 
     vm->bytesAllocated = 0;
@@ -117,11 +138,19 @@ VM* initVM(bool repl) {
 
     vm->lastModule = NULL;
 
+#ifdef DEBUG_COUNT_INSTRUCTIONS
+    vm->instructionCount = 0;
+#endif
+
     initTable(&vm->globals);
     initTable(&vm->strings);
     initTable(&vm->modules);
 
     initTable(&vm->listMethods);
+    initTable(&vm->arrayMethods);
+    initTable(&vm->mapMethods);
+    initTable(&vm->setMethods);
+    initTable(&vm->rangeMethods);
     initTable(&vm->stringMethods);
 
     vm->initString = NULL;
@@ -130,18 +159,32 @@ VM* initVM(bool repl) {
     // defining native functions
     defineNatives(vm);
     defineListMethods(vm);
+    defineArrayMethods(vm);
+    defineMapMethods(vm);
+    defineSetMethods(vm);
+    defineRangeMethods(vm);
     defineStringMethods(vm);
     return vm;
 }
 
 void freeVM(VM* vm) {
+#ifdef DEBUG_COUNT_INSTRUCTIONS
+    fprintf(stderr, "instructions executed: %llu\n", vm->instructionCount);
+#endif
     freeTable(vm, &vm->globals);
     freeTable(vm, &vm->strings);
     freeTable(vm, &vm->modules);
     freeTable(vm, &vm->listMethods);
+    freeTable(vm, &vm->arrayMethods);
+    freeTable(vm, &vm->mapMethods);
+    freeTable(vm, &vm->setMethods);
+    freeTable(vm, &vm->rangeMethods);
     freeTable(vm, &vm->stringMethods);
     vm->initString = NULL;
     freeObjects(vm);
+    free(vm->stack);
+    free(vm->openUpvalues);
+    free(vm->frames);
     free(vm);
 }
 
@@ -160,14 +203,73 @@ static Value peek(VM* vm, int distance) {
 }
 
 /**
- * @brief Method to call a function object
+ * @brief Method to make room for `needed` more values above the stack top.
+ * A larger stack is allocated when needed, and the frame slots, open
+ * upvalues and stack top are moved over to it.
  *
- * @param function Pointer to the function to call
- * @param argCount The number of arguments to the function
- * @return bool True
+ * @param needed Number of values to make room for
+ * @return bool False if the stack would grow past STACK_MAX
  */
-static bool call(VM* vm, ObjClosure* closure, int argCount) {
-    // checking argument numbers
+static bool ensureStack(VM* vm, int needed) {
+    int used = (int)(vm->stackTop - vm->stack);
+    if (used + needed <= vm->stackCapacity) return true;
+    if (used + needed > STACK_MAX) return false;
+
+    int capacity = vm->stackCapacity;
+    while (capacity < used + needed) capacity *= 2;
+    if (capacity > STACK_MAX) capacity = STACK_MAX;
+
+    Value* stack = (Value*)malloc(sizeof(Value) * capacity);
+    if (stack == NULL) exit(1);
+    memcpy(stack, vm->stack, sizeof(Value) * used);
+
+    for (int i = 0; i < vm->frameCount; i++) {
+        vm->frames[i].slots = stack + (vm->frames[i].slots - vm->stack);
+    }
+    ObjUpvalue** openUpvalues = (ObjUpvalue**)realloc(vm->openUpvalues,
+                                            sizeof(ObjUpvalue*) * capacity);
+    if (openUpvalues == NULL) exit(1);
+    memset(openUpvalues + vm->stackCapacity, 0,
+           sizeof(ObjUpvalue*) * (capacity - vm->stackCapacity));
+    for (int i = 0; i < vm->openTop; i++) {
+        if (openUpvalues[i] != NULL) openUpvalues[i]->location = stack + i;
+    }
+    vm->openUpvalues = openUpvalues;
+    vm->stackTop = stack + used;
+
+    free(vm->stack);
+    vm->stack = stack;
+    vm->stackCapacity = capacity;
+    return true;
+}
+
+/**
+ * @brief Method to make room for one more call frame
+ *
+ * @return bool False if there would be more than FRAMES_MAX frames
+ */
+static bool ensureFrame(VM* vm) {
+    if (vm->frameCount < vm->frameCapacity) return true;
+    if (vm->frameCount == FRAMES_MAX) return false;
+
+    int capacity = vm->frameCapacity * 2;
+    if (capacity > FRAMES_MAX) capacity = FRAMES_MAX;
+    CallFrame* frames = (CallFrame*)realloc(vm->frames,
+                                            sizeof(CallFrame) * capacity);
+    if (frames == NULL) exit(1);
+    vm->frames = frames;
+    vm->frameCapacity = capacity;
+    return true;
+}
+
+/**
+ * @brief Method to check the number of arguments passed to a closure
+ *
+ * @param closure The closure being called
+ * @param argCount The number of arguments
+ * @return bool True if the counts match
+ */
+static bool checkArity(VM* vm, ObjClosure* closure, int argCount) {
     if ( argCount != closure->function->params ) {
         runtimeError(vm, "Function %s() expected %d arguments but got %d.",
                 closure->function->name->chars,
@@ -175,7 +277,20 @@ static bool call(VM* vm, ObjClosure* closure, int argCount) {
                 argCount);
         return false;
     }
-    if (vm->frameCount == FRAMES_MAX) {
+    return true;
+}
+
+/**
+ * @brief Method to call a function object
+ *
+ * @param closure Pointer to the closure to call
+ * @param argCount The number of arguments to the function
+ * @return bool True if the call frame was set up
+ */
+static bool call(VM* vm, ObjClosure* closure, int argCount) {
+    if (!checkArity(vm, closure, argCount)) return false;
+    int needed = closure->function->stackSize + FRAME_SLACK;
+    if (!ensureFrame(vm) || !ensureStack(vm, needed)) {
         runtimeError(vm, "Stack overflow.");
         return false;
     }
@@ -188,6 +303,47 @@ static bool call(VM* vm, ObjClosure* closure, int argCount) {
     return true;
 }
 
+/**
+ * @brief Method to call a native function. The argument count is checked
+ * against the native's arity here, so natives need not check it
+ * themselves, and numeric natives get their arguments unboxed.
+ *
+ * @param native The native to call
+ * @param argCount The number of arguments
+ * @param args The arguments, starting from the receiver for native methods
+ * @return bool False if the call failed
+ */
+static bool callNative(VM* vm, ObjNative* native, int argCount, Value* args) {
+    if (native->arity != ARITY_ANY && argCount != native->arity) {
+        runtimeError(vm, "Function %s() expected %d arguments but got %d.",
+                native->name->chars,
+                native->arity,
+                argCount);
+        return false;
+    }
+
+    Value result;
+    if (native->numeric != NULL) {
+        double numbers[NUMERIC_ARGS_MAX];
+        for (int i = 0; i < argCount; i++) {
+            if (!IS_NUMBER(args[i])) {
+                runtimeError(vm, "Function %s() expects number arguments.",
+                             native->name->chars);
+                return false;
+            }
+            numbers[i] = AS_NUMBER(args[i]);
+        }
+        result = NUMBER_VAL(native->numeric(numbers));
+    } else {
+        result = native->function(vm, argCount, args);
+        if (IS_BAD(result)) return false;
+    }
+
+    vm->stackTop -= argCount + 1;
+    push(vm, result);
+    return true;
+}
+
 /**
  * @brief Method to execute the call to a callable object
  *
@@ -217,13 +373,9 @@ static bool callValue(VM* vm, Value callee, int argCount) {
             }
             case OBJ_CLOSURE:
                 return call(vm, AS_CLOSURE(callee), argCount);
-            case OBJ_NATIVE: {
-                NativeFn native = AS_NATIVE(callee);
-                Value result = native(vm, argCount, vm->stackTop-argCount);
-                vm->stackTop -= argCount + 1;
-                push(vm, result);
-                return true;
-            }
+            case OBJ_NATIVE:
+                return callNative(vm, AS_NATIVE(callee), argCount,
+                                  vm->stackTop - argCount);
             default:
                 break; // non-callable object type
         }
@@ -233,32 +385,198 @@ static bool callValue(VM* vm, Value callee, int argCount) {
 }
 
 static bool callNativeMethod(VM* vm, Value method, int argCount) {
-    NativeFn native = AS_NATIVE(method);
-    Value result = native(vm, argCount, vm->stackTop-argCount-1);
+    return callNative(vm, AS_NATIVE(method), argCount,
+                      vm->stackTop - argCount - 1);
+}
 
-    if (IS_BAD(result)) return false;
+/**
+ * @brief Method to bind a method of a class to the instance on top of the
+ * stack. Every binding is a new object, so two bound methods are only equal
+ * if they came from the same binding.
+ *
+ * @param klass The class to bind to 
+ * @param name The name of the method
+ * @return bool True if method is defined and bound
+ */
+static bool bindMethod(VM* vm, ObjClass* klass, ObjString* name) {
+    Value method;
+    if (!tableGet(&klass->methods, name, &method)) {
+        runtimeError(vm, "Undefined property '%s'.", name->chars);
+        return false;
+    }
 
-    vm->stackTop -= argCount +1;
-    push(vm, result);
+    ObjBoundMethod* bound = newBoundMethod(vm, peek(vm, 0), AS_CLOSURE(method));
+    pop(vm);
+    push(vm, OBJ_VAL(bound));
     return true;
 }
 
 /**
- * @brief Function to invoke the correct method from a class.
+ * @brief Method to capture a new upvalue. Open upvalues are indexed by the
+ * stack slot they point to, so a captured local is found directly.
+ *
+ * @param local The value to capture
+ * @return ObjUpvalue* A pointer to the caputred upvalue
+ */
+static ObjUpvalue* captureUpvalue(VM* vm, Value* local) {
+    int slot = (int)(local - vm->stack);
+    if (vm->openUpvalues[slot] != NULL) {
+        return vm->openUpvalues[slot]; // return an existing upvalue
+    }
+
+    ObjUpvalue* createdUpvalue = newUpvalue(vm, local);
+    vm->openUpvalues[slot] = createdUpvalue;
+    if (slot >= vm->openTop) vm->openTop = slot + 1;
+    return createdUpvalue;
+}
+
+/**
+ * @brief Method to close the open upvalues at and above a stack slot. Only
+ * the slots below the highest open upvalue are visited, so returning from a
+ * frame that captured nothing costs a single compare.
+ *
+ * @param last Pointer to the lowest stack slot to close
+ */
+static void closeUpvalues(VM* vm, Value* last) {
+    int slot = (int)(last - vm->stack);
+    for (int i = slot; i < vm->openTop; i++) {
+        ObjUpvalue* upvalue = vm->openUpvalues[i];
+        if (upvalue == NULL) continue;
+        upvalue->closed = *upvalue->location;
+        upvalue->location = &upvalue->closed;
+        vm->openUpvalues[i] = NULL;
+    }
+    if (slot < vm->openTop) vm->openTop = slot;
+}
+
+/**
+ * @brief Method to call a closure in place of the current frame. Upvalues
+ * over the caller's slots are closed and the callee and its arguments slide
+ * down over them, so a chain of tail calls runs in constant stack space.
+ *
+ * @param closure Pointer to the closure to call
+ * @param argCount The number of arguments to the function
+ * @return bool True if the frame was reused
+ */
+static bool tailCall(VM* vm, ObjClosure* closure, int argCount) {
+    if (!checkArity(vm, closure, argCount)) return false;
+    CallFrame* frame = &vm->frames[vm->frameCount-1];
+    closeUpvalues(vm, frame->slots);
+
+    memmove(frame->slots, vm->stackTop - argCount - 1,
+            sizeof(Value) * (argCount + 1));
+    vm->stackTop = frame->slots + argCount + 1;
+    frame->closure = closure;
+    frame->ip = closure->function->chunk.code;
+
+    if (!ensureStack(vm, closure->function->stackSize + FRAME_SLACK)) {
+        runtimeError(vm, "Stack overflow.");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Method to call a value in tail position. Closures and bound
+ * methods reuse the current frame, while anything else is called as usual
+ * and returns through the OP_RETURN that follows.
+ *
+ * @param callee Object to call
+ * @param argCount The number of arguments
+ * @return bool True if object is callable.
+ */
+static bool tailCallValue(VM* vm, Value callee, int argCount) {
+    if (IS_CLOSURE(callee)) {
+        return tailCall(vm, AS_CLOSURE(callee), argCount);
+    }
+    if (IS_BOUND_METHOD(callee)) {
+        ObjBoundMethod* bound = AS_BOUND_METHOD(callee);
+        vm->stackTop[-argCount-1] = bound->receiver;
+        return tailCall(vm, bound->method, argCount);
+    }
+    return callValue(vm, callee, argCount);
+}
+
+/**
+ * @brief Method to find a method through the invoke cache of a call site,
+ * refilling the cache from the class on a miss
+ *
+ * @param klass The class to find the method in
+ * @param name The name of the method
+ * @param cache The invoke cache of the call site
+ * @return ObjClosure* The method, NULL if the class has none by that name
+ */
+static inline ObjClosure* findMethod(ObjClass* klass, ObjString* name,
+                                     InvokeCache* cache) {
+    if (cache->klass == (Obj*)klass) return (ObjClosure*)cache->method;
+
+    Value method;
+    if (!tableGet(&klass->methods, name, &method)) return NULL;
+    cache->klass = (Obj*)klass;
+    cache->method = AS_OBJ(method);
+    return AS_CLOSURE(method);
+}
+
+/**
+ * @brief Method to run a getter or setter in place of calling it. Getters
+ * are only run here when the field exists, so that a missing field behaves
+ * as it would inside the method.
+ *
+ * @param instance The receiver of the call
+ * @param function The invoked method
+ * @param argCount The number of arguments
+ * @return bool True if the accessor was run, false if it needs a call
+ */
+static inline bool runAccessor(VM* vm, ObjInstance* instance,
+                               ObjFunction* function, int argCount) {
+    switch (function->accessor) {
+        case ACCESSOR_GET: {
+            Value value;
+            if (argCount != 0 ||
+                !tableGet(&instance->fields, function->field, &value)) {
+                return false;
+            }
+            vm->stackTop[-1] = value;
+            return true;
+        }
+        case ACCESSOR_SET:
+        case ACCESSOR_SET_THIS:
+            if (argCount != 1) return false;
+            tableSet(vm, &instance->fields, function->field, peek(vm, 0));
+            pop(vm);
+            if (function->accessor == ACCESSOR_SET) vm->stackTop[-1] = NULL_VAL;
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Function to invoke the correct method from a class. Accessors are
+ * run without a call frame.
  *
  * @param klass The class from which to find the method from
  * @param name The name of the called method
  * @param argCount The number of arguments
+ * @param cache The invoke cache of the call site
+ * @param tail True if the call is in tail position
  * @return bool True if invocation from given class was successful
  */
-static bool invokeFromClass(VM* vm, ObjClass* klass, ObjString* name, int argCount) {
-    Value method;
-    if (!tableGet(&klass->methods, name, &method)) {
+static bool invokeFromClass(VM* vm, ObjClass* klass, ObjString* name,
+                            int argCount, InvokeCache* cache, bool tail) {
+    ObjClosure* method = findMethod(klass, name, cache);
+    if (method == NULL) {
         runtimeError(vm, "Undefined method '%s' in class '%s'.",
                 name->chars, klass->name->chars);
         return false;
     }
-    return call(vm, AS_CLOSURE(method), argCount);
+    if (method->function->accessor != ACCESSOR_NONE &&
+        runAccessor(vm, AS_INSTANCE(peek(vm, argCount)), method->function,
+                    argCount)) {
+        return true;
+    }
+    return tail ? tailCall(vm, method, argCount) :
+                  call(vm, method, argCount);
 }
 
 /**
@@ -266,9 +584,12 @@ static bool invokeFromClass(VM* vm, ObjClass* klass, ObjString* name, int argCou
  *
  * @param name Name of possibly invoked method
  * @param argCount Number of arguments passed into method call
+ * @param cache The invoke cache of the call site
+ * @param tail True if the call is in tail position
  * @return bool True if invocation is successful
  */
-static bool invoke(VM* vm, ObjString* name, int argCount) {
+static bool invoke(VM* vm, ObjString* name, int argCount, InvokeCache* cache,
+                   bool tail) {
     Value receiver = peek(vm, argCount);
     if (!IS_OBJ(receiver)) {
         runtimeError(vm, "Invalid method call '%s()' to unsupported type.",
@@ -277,6 +598,8 @@ static bool invoke(VM* vm, ObjString* name, int argCount) {
     }
     switch (getObjType(receiver)) {
         default:
+            runtimeError(vm, "Invalid method call '%s()' to unsupported type.",
+                         name->chars);
             return false;
         case OBJ_MODULE: {
             ObjModule* module = AS_MODULE(receiver);
@@ -286,7 +609,12 @@ static bool invoke(VM* vm, ObjString* name, int argCount) {
                              name->chars, module->name->chars);
                 return false;
             }
-            return callValue(vm, value, argCount);
+            if (IS_NATIVE(value)) {
+                return callNative(vm, AS_NATIVE(value), argCount,
+                                  vm->stackTop - argCount);
+            }
+            return tail ? tailCallValue(vm, value, argCount) :
+                          callValue(vm, value, argCount);
         }
         case OBJ_LIST: {
             Value value;
@@ -296,6 +624,39 @@ static bool invoke(VM* vm, ObjString* name, int argCount) {
             }
             return callNativeMethod(vm, value, argCount);
         }
+        case OBJ_ARRAY: {
+            Value value;
+            if (!tableGet(&vm->arrayMethods, name, &value)) {
+                runtimeError(vm, "No Float64Array method '%s()' found.",
+                             name->chars);
+                return false;
+            }
+            return callNativeMethod(vm, value, argCount);
+        }
+        case OBJ_MAP: {
+            Value value;
+            if (!tableGet(&vm->mapMethods, name, &value)) {
+                runtimeError(vm, "No map method '%s()' found.", name->chars);
+                return false;
+            }
+            return callNativeMethod(vm, value, argCount);
+        }
+        case OBJ_SET: {
+            Value value;
+            if (!tableGet(&vm->setMethods, name, &value)) {
+                runtimeError(vm, "No set method '%s()' found.", name->chars);
+                return false;
+            }
+            return callNativeMethod(vm, value, argCount);
+        }
+        case OBJ_RANGE: {
+            Value value;
+            if (!tableGet(&vm->rangeMethods, name, &value)) {
+                runtimeError(vm, "No range method '%s()' found.", name->chars);
+                return false;
+            }
+            return callNativeMethod(vm, value, argCount);
+        }
         case OBJ_STRING: {
             Value value;
             if (!tableGet(&vm->stringMethods, name, &value)) {
@@ -312,76 +673,94 @@ static bool invoke(VM* vm, ObjString* name, int argCount) {
             Value value;
             if (tableGet(&instance->fields, name, &value)) {
                 vm->stackTop[-argCount -1] = value;
-                return callValue(vm, value, argCount);
+                return tail ? tailCallValue(vm, value, argCount) :
+                              callValue(vm, value, argCount);
             }
-            return invokeFromClass(vm, instance->klass, name, argCount);
+            return invokeFromClass(vm, instance->klass, name, argCount,
+                                   cache, tail);
         }
     }
 }
 
 /**
- * @brief Method to bind a method to a class
+ * @brief Method to check a Float64Array subscript, turning a negative index
+ * into one counted from the front
  *
- * @param klass The class to bind to 
- * @param name The name of the method
- * @return bool True if method is defined and bound
+ * @param array The subscripted array
+ * @param index The index, updated in place
+ * @return bool False after a runtime error
  */
-static bool bindMethod(VM* vm, ObjClass* klass, ObjString* name) {
-    Value method;
-    if (!tableGet(&klass->methods, name, &method)) {
-        runtimeError(vm, "Undefined property '%s'.", name->chars);
+static bool arrayIndex(VM* vm, ObjArray* array, int* index) {
+    int i = *index < 0 ? *index + array->count : *index;
+    if (i < 0 || i >= array->count) {
+        runtimeError(vm, "Float64Array index out of bounds (given %d, length %d)",
+                     *index, array->count);
         return false;
     }
-
-    ObjBoundMethod* bound = newBoundMethod(vm, peek(vm, 0), AS_CLOSURE(method));
-    pop(vm);
-    push(vm, OBJ_VAL(bound));
+    *index = i;
     return true;
 }
 
 /**
- * @brief Method to capture a new upvalue
+ * @brief Method to store a number into a Float64Array. Unlike lists,
+ * arrays keep their length, so indices past the end are an error.
  *
- * @param local The value to capture
- * @return ObjUpvalue* A pointer to the caputred upvalue
+ * @param array The subscripted array
+ * @param possibleIndex The subscript value
+ * @param item The value to store
+ * @return bool False after a runtime error
  */
-static ObjUpvalue* captureUpvalue(VM* vm, Value* local) {
-    ObjUpvalue* prevUpvalue = NULL;
-    ObjUpvalue* upvalue = vm->openUpvalues;
-    // traversing the linked list of upvalues
-    while (upvalue != NULL && upvalue->location > local) {
-        prevUpvalue = upvalue;
-        upvalue = upvalue->next;
+static bool setArrayIndex(VM* vm, ObjArray* array, Value possibleIndex,
+                          Value item) {
+    if (!IS_NUMBER(possibleIndex)) {
+        runtimeError(vm, "Subscript index must be a number.");
+        return false;
     }
-
-    if (upvalue != NULL && upvalue->location == local) {
-        return upvalue; // return an existing upvalue
+    if (!IS_NUMBER(item)) {
+        runtimeError(vm, "Float64Array values must be numbers.");
+        return false;
     }
+    int index = AS_INTEGER(possibleIndex);
+    if (!arrayIndex(vm, array, &index)) return false;
+    array->values[index] = AS_NUMBER(item);
+    return true;
+}
 
-    ObjUpvalue* createdUpvalue = newUpvalue(vm, local);
-    createdUpvalue->next = upvalue;
-
-    if (prevUpvalue == NULL) {
-        vm->openUpvalues = createdUpvalue; // add to head if empty head
-    } else {
-        prevUpvalue->next = createdUpvalue; // add to after prev if not empty
+/**
+ * @brief Method to check if a value can be looped over with for-in
+ *
+ */
+static bool isIterable(Value value) {
+    if (!IS_OBJ(value)) return false;
+    switch (OBJ_TYPE(value)) {
+        case OBJ_LIST:
+        case OBJ_ARRAY:
+        case OBJ_STRING:
+        case OBJ_MAP:
+        case OBJ_SET:
+        case OBJ_RANGE:
+            return true;
+        default:
+            return false;
     }
-    return createdUpvalue;
 }
 
 /**
- * @brief Method to close open upvalues
+ * @brief Method to look up a map key, raising an error if it is missing
  *
- * @param last Pointer to the last upvalue visited
+ * @param map The subscripted map
+ * @param key The key to look up
+ * @param value Set to the value of the key
+ * @return bool False after a runtime error
  */
-static void closeUpvalues(VM* vm, Value* last) {
-    while (vm->openUpvalues != NULL &&
-           vm->openUpvalues->location >= last) {
-        ObjUpvalue* upvalue = vm->openUpvalues;
-        upvalue->closed = *upvalue->location;
-        upvalue->location = &upvalue->closed;
-        vm->openUpvalues = upvalue->next;
+static bool mapIndex(VM* vm, ObjMap* map, Value key, Value* value) {
+    if (valueTableGet(&map->table, key, value)) return true;
+    if (IS_STRING(key)) {
+        runtimeError(vm, "Key '%s' not found in map.", AS_CSTRING(key));
+    } else {
+        runtimeError(vm, "Key not found in map.");
     }
+    return false;
 }
 
 /**
@@ -396,16 +775,6 @@ static void defineMethod(VM* vm, ObjString* name) {
     pop(vm);
 }
 
-/**
- * @brief Method to determine if a value is "falsey"
- *
- * @param value Value to check false-ness
- * @return True if value is falsey
- */
-static bool isFalsey(Value value) {
-    return IS_NULL(value) || (IS_BOOL(value) && !AS_BOOL(value));
-}
-
 /**
  * @brief Method to convert a number to a string.
  *
@@ -476,7 +845,89 @@ static void concatenate(VM* vm) {
     push(vm, OBJ_VAL(result));
 }
 
-static InterpretResult run(VM* vm) {
+/**
+ * @brief Method to join the two lists on top of the stack into a new list,
+ * sized exactly for both
+ *
+ */
+static void concatenateLists(VM* vm) {
+    ObjList* b = AS_LIST(peek(vm, 0));
+    ObjList* a = AS_LIST(peek(vm, 1));
+    ObjList* result = newList(vm);
+    push(vm, OBJ_VAL(result));
+    reserveList(vm, result, a->items.count + b->items.count);
+    extendList(vm, result, a);
+    extendList(vm, result, b);
+    vm->stackTop -= 3;
+    push(vm, OBJ_VAL(result));
+}
+
+/**
+ * @brief Slow path of the register-style ops, taken when the operands are
+ * not both numbers. The operands are on top of the stack and are replaced
+ * by the result, the same way the generic stack instruction would.
+ *
+ * @param op The generic stack instruction
+ * @return bool False if a runtime error was raised
+ */
+static bool slowBinaryOp(VM* vm, uint8_t op) {
+    if (op == OP_ADD) {
+        if (IS_STRING(peek(vm,0)) || IS_STRING(peek(vm,1))) {
+            concatenate(vm);
+            return true;
+        }
+        if (IS_LIST(peek(vm,0)) && IS_LIST(peek(vm,1))) {
+            concatenateLists(vm);
+            return true;
+        }
+        runtimeError(vm, "Operands must be two numbers, strings or lists.");
+        return false;
+    }
+    runtimeError(vm, "Operands must be numbers.");
+    return false;
+}
+
+#if defined(DEBUG_TRACE_EXECUTION) || defined(DEBUG_COUNT_INSTRUCTIONS)
+/**
+ * @brief Method run before every instruction in debug builds. Prints the
+ * stack and the instruction about to be executed, and counts instructions.
+ *
+ * @param vm The virtual machine
+ * @param frame The current call frame
+ */
+static void beforeInstruction(VM* vm, CallFrame* frame) {
+#ifdef DEBUG_TRACE_EXECUTION
+    // printing the stack 
+    printf("          ");
+    for (Value* slot = vm->stack; slot < vm->stackTop; slot++) {
+        printf("[ ");
+        printValue(stdout, *slot);
+        printf(" ]");
+    }
+    printf("\n");
+    // pass in the current callframe instead of the vm->s chunk and ip fields
+    disassembleInstruction( &frame->closure->function->chunk,
+            (int)(frame->ip - frame->closure->function->chunk.code) );
+#else
+    UNUSED(frame);
+#endif
+#ifdef DEBUG_COUNT_INSTRUCTIONS
+    vm->instructionCount++;
+#else
+    UNUSED(vm);
+#endif
+}
+#endif
+
+/**
+ * @brief Method to run bytecode until the frame at `baseFrame` returns. Its
+ * return value is left on top of the stack. Runs are nested when natives
+ * call back into the VM, and a runtime error unwinds all of them.
+ *
+ * @param baseFrame Number of frames below the ones this run executes
+ * @return InterpretResult
+ */
+static InterpretResult run(VM* vm, int baseFrame) {
     CallFrame* frame = &vm->frames[vm->frameCount-1];
     // register uint8_t* ip = frame->ip;
 
@@ -492,56 +943,220 @@ static InterpretResult run(VM* vm) {
 
 #define READ_STRING()   AS_STRING(READ_CONSTANT())
 
+#define READ_CACHE() \
+    ( &frame->closure->function->chunk.caches[READ_SHORT()] )
+
+// results of ops on two ints: arithmetic stays on ints unless it overflows
+#define INT_ARITH(valueType, x, op, y) \
+    intToValue((int64_t)(x) op (int64_t)(y))
+#define INT_PRODUCT(valueType, x, op, y) intProduct((x), (y))
+#define INT_QUOTIENT(valueType, x, op, y) valueType((double)(x) op (double)(y))
+#define INT_COMPARE(valueType, x, op, y)  valueType((x) op (y))
+
+// evaluates to true and sets `result` if both values are numbers
+#define NUMBER_OP(result, a, b, valueType, intType, op) \
+    ( IS_DOUBLE(a) && IS_DOUBLE(b) ? \
+        ((result) = valueType(AS_DOUBLE(a) op AS_DOUBLE(b)), true) : \
+      IS_INT(a) && IS_INT(b) ? \
+        ((result) = intType(valueType, AS_INT(a), op, AS_INT(b)), true) : \
+      IS_NUMBER(a) && IS_NUMBER(b) ? \
+        ((result) = valueType(AS_NUMBER(a) op AS_NUMBER(b)), true) : \
+      false )
+
 // macro for binary operation handling
-#define BINARY_OP(vm, valueType, op) \
+#define BINARY_OP(vm, valueType, intType, op) \
     do { \
-      if (!IS_NUMBER(peek(vm, 0)) || !IS_NUMBER(peek(vm, 1))) { \
+      Value b = peek(vm, 0); \
+      Value a = peek(vm, 1); \
+      Value result; \
+      if (!NUMBER_OP(result, a, b, valueType, intType, op)) { \
         runtimeError(vm, "Operands must be numbers."); \
         return INTERPRET_RUNTIME_ERROR; \
       } \
-      double b = AS_NUMBER(pop(vm)); \
-      double a = AS_NUMBER(pop(vm)); \
-      push(vm, valueType(a op b)); \
+      pop(vm); \
+      pop(vm); \
+      push(vm, result); \
     } while (false)
 
-    for (;;) {
-#ifdef DEBUG_TRACE_EXECUTION
-        // printing the stack 
-        printf("          ");
-        for (Value* slot = vm->stack; slot < vm->stackTop; slot++) {
-            printf("[ ");
-            printValue(stdout, *slot);
-            printf(" ]");
-        }
-        printf("\n");
-        // pass in the current callframe instead of the vm->s chunk and ip fields
-        disassembleInstruction( &frame->closure->function->chunk,
-                (int)(frame->ip - frame->closure->function->chunk.code) );
+#define NOT_BOOL_VAL(b) BOOL_VAL(!(b))
+
+#define READ_LOCAL()    ( frame->slots[READ_BYTE()] )
+
+// register-style op on two values read from the instruction operands
+#define REGISTER_OP(vm, genericOp, valueType, intType, op, left, right, \
+                    store) \
+    do { \
+      Value a = left; \
+      Value b = right; \
+      Value result; \
+      if (NUMBER_OP(result, a, b, valueType, intType, op)) { \
+        store(result); \
+      } else { \
+        push(vm, a); \
+        push(vm, b); \
+        if (!slowBinaryOp(vm, genericOp)) return INTERPRET_RUNTIME_ERROR; \
+        store(pop(vm)); \
+      } \
+    } while (false)
+
+#define PUSH_RESULT(value)  push(vm, value)
+#define STORE_RESULT(value) ( frame->slots[dest] = (value) )
+
+// jump forward when the comparison of two operand values does not hold
+#define COMPARE_BRANCH(vm, op, left, right) \
+    do { \
+      Value a = left; \
+      Value b = right; \
+      uint16_t offset = READ_SHORT(); \
+      Value result; \
+      if (!NUMBER_OP(result, a, b, BOOL_VAL, INT_COMPARE, op)) { \
+        runtimeError(vm, "Operands must be numbers."); \
+        return INTERPRET_RUNTIME_ERROR; \
+      } \
+      if (!AS_BOOL(result)) frame->ip += offset; \
+    } while (false)
+
+#if defined(DEBUG_TRACE_EXECUTION) || defined(DEBUG_COUNT_INSTRUCTIONS)
+#define BEFORE_INSTRUCTION() beforeInstruction(vm, frame)
+#else
+#define BEFORE_INSTRUCTION() ((void)0)
 #endif
 
-        uint8_t instruction;
-        switch (instruction = READ_BYTE()) {
-            case OP_CONSTANT: {
+#ifdef THREADED_DISPATCH
+    // every opcode handled below needs an entry here
+    static void* dispatchTable[] = {
+        [OP_CONSTANT] = &&TARGET_OP_CONSTANT,
+        [OP_NULL] = &&TARGET_OP_NULL,
+        [OP_TRUE] = &&TARGET_OP_TRUE,
+        [OP_FALSE] = &&TARGET_OP_FALSE,
+        [OP_POP] = &&TARGET_OP_POP,
+        [OP_SET_LOCAL] = &&TARGET_OP_SET_LOCAL,
+        [OP_SET_LOCAL_POP] = &&TARGET_OP_SET_LOCAL_POP,
+        [OP_GET_LOCAL] = &&TARGET_OP_GET_LOCAL,
+        [OP_GET_GLOBAL] = &&TARGET_OP_GET_GLOBAL,
+        [OP_DEFINE_GLOBAL] = &&TARGET_OP_DEFINE_GLOBAL,
+        [OP_SET_GLOBAL] = &&TARGET_OP_SET_GLOBAL,
+        [OP_GET_MODULE] = &&TARGET_OP_GET_MODULE,
+        [OP_DEFINE_MODULE] = &&TARGET_OP_DEFINE_MODULE,
+        [OP_SET_MODULE] = &&TARGET_OP_SET_MODULE,
+        [OP_MAKE_LIST] = &&TARGET_OP_MAKE_LIST,
+        [OP_MAKE_MAP] = &&TARGET_OP_MAKE_MAP,
+        [OP_SUBSCRIPT_ASSIGN] = &&TARGET_OP_SUBSCRIPT_ASSIGN,
+        [OP_SUBSCRIPT_IDX] = &&TARGET_OP_SUBSCRIPT_IDX,
+        [OP_SUBSCRIPT_IDX_NOPOP] = &&TARGET_OP_SUBSCRIPT_IDX_NOPOP,
+        [OP_SLICE] = &&TARGET_OP_SLICE,
+        [OP_GET_UPVALUE] = &&TARGET_OP_GET_UPVALUE,
+        [OP_SET_UPVALUE] = &&TARGET_OP_SET_UPVALUE,
+        [OP_GET_PROPERTY] = &&TARGET_OP_GET_PROPERTY,
+        [OP_SET_PROPERTY] = &&TARGET_OP_SET_PROPERTY,
+        [OP_GET_PROPERTY_NOPOP] = &&TARGET_OP_GET_PROPERTY_NOPOP,
+        [OP_GET_SUPER] = &&TARGET_OP_GET_SUPER,
+        [OP_EQUAL] = &&TARGET_OP_EQUAL,
+        [OP_NOT_EQUAL] = &&TARGET_OP_NOT_EQUAL,
+        [OP_GREATER] = &&TARGET_OP_GREATER,
+        [OP_LESS] = &&TARGET_OP_LESS,
+        [OP_GREATER_EQUAL] = &&TARGET_OP_GREATER_EQUAL,
+        [OP_LESS_EQUAL] = &&TARGET_OP_LESS_EQUAL,
+        [OP_ADD] = &&TARGET_OP_ADD,
+        [OP_SUBTRACT] = &&TARGET_OP_SUBTRACT,
+        [OP_MULTIPLY] = &&TARGET_OP_MULTIPLY,
+        [OP_DIVIDE] = &&TARGET_OP_DIVIDE,
+        [OP_MOD] = &&TARGET_OP_MOD,
+        [OP_ADD_LL] = &&TARGET_OP_ADD_LL,
+        [OP_SUBTRACT_LL] = &&TARGET_OP_SUBTRACT_LL,
+        [OP_MULTIPLY_LL] = &&TARGET_OP_MULTIPLY_LL,
+        [OP_DIVIDE_LL] = &&TARGET_OP_DIVIDE_LL,
+        [OP_LESS_LL] = &&TARGET_OP_LESS_LL,
+        [OP_GREATER_LL] = &&TARGET_OP_GREATER_LL,
+        [OP_ADD_LC] = &&TARGET_OP_ADD_LC,
+        [OP_SUBTRACT_LC] = &&TARGET_OP_SUBTRACT_LC,
+        [OP_MULTIPLY_LC] = &&TARGET_OP_MULTIPLY_LC,
+        [OP_DIVIDE_LC] = &&TARGET_OP_DIVIDE_LC,
+        [OP_LESS_LC] = &&TARGET_OP_LESS_LC,
+        [OP_GREATER_LC] = &&TARGET_OP_GREATER_LC,
+        [OP_ADD_LL_SET] = &&TARGET_OP_ADD_LL_SET,
+        [OP_SUBTRACT_LL_SET] = &&TARGET_OP_SUBTRACT_LL_SET,
+        [OP_MULTIPLY_LL_SET] = &&TARGET_OP_MULTIPLY_LL_SET,
+        [OP_DIVIDE_LL_SET] = &&TARGET_OP_DIVIDE_LL_SET,
+        [OP_ADD_LC_SET] = &&TARGET_OP_ADD_LC_SET,
+        [OP_SUBTRACT_LC_SET] = &&TARGET_OP_SUBTRACT_LC_SET,
+        [OP_MULTIPLY_LC_SET] = &&TARGET_OP_MULTIPLY_LC_SET,
+        [OP_DIVIDE_LC_SET] = &&TARGET_OP_DIVIDE_LC_SET,
+        [OP_INCREMENT_LOCAL] = &&TARGET_OP_INCREMENT_LOCAL,
+        [OP_DECREMENT_LOCAL] = &&TARGET_OP_DECREMENT_LOCAL,
+        [OP_JUMP_IF_NOT_LESS_LL] = &&TARGET_OP_JUMP_IF_NOT_LESS_LL,
+        [OP_JUMP_IF_NOT_GREATER_LL] = &&TARGET_OP_JUMP_IF_NOT_GREATER_LL,
+        [OP_JUMP_IF_NOT_LESS_LC] = &&TARGET_OP_JUMP_IF_NOT_LESS_LC,
+        [OP_JUMP_IF_NOT_GREATER_LC] = &&TARGET_OP_JUMP_IF_NOT_GREATER_LC,
+        [OP_INCREMENT] = &&TARGET_OP_INCREMENT,
+        [OP_DECREMENT] = &&TARGET_OP_DECREMENT,
+        [OP_MODULE] = &&TARGET_OP_MODULE,
+        [OP_MODULE_VAR] = &&TARGET_OP_MODULE_VAR,
+        [OP_MODULE_END] = &&TARGET_OP_MODULE_END,
+        [OP_MODULE_BUILTIN] = &&TARGET_OP_MODULE_BUILTIN,
+        [OP_NOT] = &&TARGET_OP_NOT,
+        [OP_NEGATE] = &&TARGET_OP_NEGATE,
+        [OP_PRINT] = &&TARGET_OP_PRINT,
+        [OP_JUMP] = &&TARGET_OP_JUMP,
+        [OP_JUMP_IF_FALSE] = &&TARGET_OP_JUMP_IF_FALSE,
+        [OP_LOOP] = &&TARGET_OP_LOOP,
+        [OP_ITER_INIT] = &&TARGET_OP_ITER_INIT,
+        [OP_ITER_NEXT] = &&TARGET_OP_ITER_NEXT,
+        [OP_CALL] = &&TARGET_OP_CALL,
+        [OP_CALL_NATIVE] = &&TARGET_OP_CALL_NATIVE,
+        [OP_INVOKE] = &&TARGET_OP_INVOKE,
+        [OP_SUPER_INVOKE] = &&TARGET_OP_SUPER_INVOKE,
+        [OP_TAIL_CALL] = &&TARGET_OP_TAIL_CALL,
+        [OP_TAIL_INVOKE] = &&TARGET_OP_TAIL_INVOKE,
+        [OP_CLOSURE] = &&TARGET_OP_CLOSURE,
+        [OP_CLOSE_UPVALUE] = &&TARGET_OP_CLOSE_UPVALUE,
+        [OP_RETURN] = &&TARGET_OP_RETURN,
+        [OP_CLASS] = &&TARGET_OP_CLASS,
+        [OP_INHERIT] = &&TARGET_OP_INHERIT,
+        [OP_METHOD] = &&TARGET_OP_METHOD,
+    };
+
+// each handler jumps straight to the handler of the next instruction
+#define TARGET(op)  case op: TARGET_##op
+#define DISPATCH() \
+    do { \
+        BEFORE_INSTRUCTION(); \
+        goto *dispatchTable[READ_BYTE()]; \
+    } while (false)
+#else
+#define TARGET(op)  case op
+#define DISPATCH()  continue
+#endif
+
+    for (;;) {
+        BEFORE_INSTRUCTION();
+        switch (READ_BYTE()) {
+            TARGET(OP_CONSTANT): {
                 Value constant = READ_CONSTANT();
                 push(vm, constant);
-                break;
+                DISPATCH();
             }
 
-            case OP_NULL:  push(vm, NULL_VAL); break;
-            case OP_TRUE:  push(vm, BOOL_VAL(true)); break;
-            case OP_FALSE: push(vm, BOOL_VAL(false)); break;
-            case OP_POP:   pop(vm); break;
-            case OP_SET_LOCAL: {
+            TARGET(OP_NULL):  push(vm, NULL_VAL); DISPATCH();
+            TARGET(OP_TRUE):  push(vm, BOOL_VAL(true)); DISPATCH();
+            TARGET(OP_FALSE): push(vm, BOOL_VAL(false)); DISPATCH();
+            TARGET(OP_POP):   pop(vm); DISPATCH();
+            TARGET(OP_SET_LOCAL): {
                 uint8_t slot = READ_BYTE();
                 frame->slots[slot] = peek(vm,0);
-                break;
+                DISPATCH();
+            }
+            TARGET(OP_SET_LOCAL_POP): {
+                uint8_t slot = READ_BYTE();
+                frame->slots[slot] = pop(vm);
+                DISPATCH();
             }
-            case OP_GET_LOCAL: {
+            TARGET(OP_GET_LOCAL): {
                 uint8_t slot = READ_BYTE();
                 push(vm, frame->slots[slot]);
-                break;
+                DISPATCH();
             }
-            case OP_GET_GLOBAL: {
+            TARGET(OP_GET_GLOBAL): {
                 ObjString* name = READ_STRING();
                 Value value;
                 if (!tableGet(&vm->globals, name, &value)) {
@@ -549,24 +1164,24 @@ static InterpretResult run(VM* vm) {
                     return INTERPRET_RUNTIME_ERROR;
                 }
                 push(vm, value);
-                break;
+                DISPATCH();
             }
-            case OP_DEFINE_GLOBAL: {
+            TARGET(OP_DEFINE_GLOBAL): {
                 ObjString* name = READ_STRING();    
                 tableSet(vm, &vm->globals, name, peek(vm,0));
                 pop(vm);
-                break;
+                DISPATCH();
             }
-            case OP_SET_GLOBAL: {
+            TARGET(OP_SET_GLOBAL): {
                 ObjString* name = READ_STRING();
                 if (tableSet(vm, &vm->globals, name, peek(vm,0))) {
                     tableDelete(vm, &vm->globals, name);
                     runtimeError(vm, "Undefined variable '%s'.", name->chars);
                     return INTERPRET_RUNTIME_ERROR;
                 }
-                break;
+                DISPATCH();
             }
-            case OP_GET_MODULE: {
+            TARGET(OP_GET_MODULE): {
                 ObjString* name = READ_STRING();
                 Value value;
                 if (!tableGet(&frame->closure->function->module->values, name, &value)) {
@@ -574,40 +1189,77 @@ static InterpretResult run(VM* vm) {
                     return INTERPRET_RUNTIME_ERROR;
                 }
                 push(vm, value);
-                break;
+                DISPATCH();
             }
-            case OP_DEFINE_MODULE: {
+            TARGET(OP_DEFINE_MODULE): {
                 ObjString* name = READ_STRING();    
                 tableSet(vm, &frame->closure->function->module->values, name, peek(vm,0));
                 pop(vm);
-                break;
+                DISPATCH();
             }
 
-            case OP_SET_MODULE: {
+            TARGET(OP_SET_MODULE): {
                 ObjString* name = READ_STRING();
                 if (tableSet(vm, &frame->closure->function->module->values, name, peek(vm,0))) {
                     tableDelete(vm, &frame->closure->function->module->values, name);
                     runtimeError(vm, "Undefined variable '%s'.", name->chars);
                     return INTERPRET_RUNTIME_ERROR;
                 }
-                break;
+                DISPATCH();
             }
-            case OP_MAKE_LIST: {
+            TARGET(OP_MAKE_LIST): {
                 ObjList* list = newList(vm);
                 uint8_t numElem = READ_BYTE();
 
                 push(vm, OBJ_VAL(list));
-                for (int i = numElem; i > 0; i--) {
-                    appendList(vm, list, peek(vm, i));
+                if (numElem > 0) {
+                    reserveList(vm, list, numElem);
+                    memcpy(list->items.values, vm->stackTop - 1 - numElem,
+                           sizeof(Value) * numElem);
+                    list->items.count = numElem;
                 }
                 vm->stackTop -= numElem+1;
                 push(vm, OBJ_VAL(list));
-                break;
+                DISPATCH();
             }
-            case OP_SUBSCRIPT_ASSIGN: {
+            TARGET(OP_MAKE_MAP): {
+                ObjMap* map = newMap(vm);
+                uint8_t numPairs = READ_BYTE();
+
+                // the keys and values stay on the stack until all are in
+                push(vm, OBJ_VAL(map));
+                Value* pairs = vm->stackTop - 1 - 2*numPairs;
+                for (int i = 0; i < numPairs; i++) {
+                    if (!setMapKey(vm, map, pairs[2*i], pairs[2*i + 1])) {
+                        return INTERPRET_RUNTIME_ERROR;
+                    }
+                }
+                vm->stackTop -= 2*numPairs + 1;
+                push(vm, OBJ_VAL(map));
+                DISPATCH();
+            }
+            TARGET(OP_SUBSCRIPT_ASSIGN): {
+                if (IS_MAP(peek(vm, 2))) {
+                    // the operands stay on the stack while the table grows
+                    Value item = peek(vm, 0);
+                    if (!setMapKey(vm, AS_MAP(peek(vm, 2)), peek(vm, 1), item)) {
+                        return INTERPRET_RUNTIME_ERROR;
+                    }
+                    vm->stackTop -= 3;
+                    push(vm, item);
+                    DISPATCH();
+                }
                 Value item = pop(vm);
                 Value possibleIndex = pop(vm);
                 Value receiver = pop(vm);
+                if (IS_ARRAY(receiver)) {
+                    if (!setArrayIndex(vm, AS_ARRAY(receiver), possibleIndex,
+                                       item)) {
+                        return INTERPRET_RUNTIME_ERROR;
+                    }
+                    push(vm, item);
+                    DISPATCH();
+                }
                 if (!IS_LIST(receiver)) {
                     runtimeError(vm, "Invalid subscript operation to unsupported type.");
                     return INTERPRET_RUNTIME_ERROR;
@@ -617,7 +1269,7 @@ static InterpretResult run(VM* vm) {
                     return INTERPRET_RUNTIME_ERROR;
                 }
                 ObjList* list = AS_LIST(receiver);
-                int index = AS_NUMBER(possibleIndex);
+                int index = AS_INTEGER(possibleIndex);
 
                 if (!validIndexList(vm, list, index)) {
                     if (index > list->items.count) {
@@ -635,9 +1287,9 @@ static InterpretResult run(VM* vm) {
                 }
                 setToIndexList(vm, list, index, item);
                 push(vm, item);
-                break;
+                DISPATCH();
             }
-            case OP_SUBSCRIPT_IDX: {
+            TARGET(OP_SUBSCRIPT_IDX): {
                 Value possibleIndex = pop(vm);
                 Value receiver = pop(vm);
                 Value value;
@@ -646,11 +1298,18 @@ static InterpretResult run(VM* vm) {
                     runtimeError(vm, "Invalid subscript operation to unsupported type.");
                     return INTERPRET_RUNTIME_ERROR;
                 }
+                if (IS_MAP(receiver)) {
+                    if (!mapIndex(vm, AS_MAP(receiver), possibleIndex, &value)) {
+                        return INTERPRET_RUNTIME_ERROR;
+                    }
+                    push(vm, value);
+                    DISPATCH();
+                }
                 if (!IS_NUMBER(possibleIndex)) {
                     runtimeError(vm, "Subscript index must be a number.");
                     return INTERPRET_RUNTIME_ERROR;
                 }
-                int index = AS_NUMBER(possibleIndex);
+                int index = AS_INTEGER(possibleIndex);
 
                 // add more receivers as language expands
                 switch (OBJ_TYPE(receiver)) {
@@ -668,6 +1327,14 @@ static InterpretResult run(VM* vm) {
                         push(vm, value);
                         break;
                     }
+                    case OBJ_ARRAY: {
+                        ObjArray* array = AS_ARRAY(receiver);
+                        if (!arrayIndex(vm, array, &index)) {
+                            return INTERPRET_RUNTIME_ERROR;
+                        }
+                        push(vm, NUMBER_VAL(array->values[index]));
+                        break;
+                    }
                     case OBJ_STRING: {
                         ObjString* str = AS_STRING(receiver);
                         if (index > str->length) {
@@ -681,13 +1348,29 @@ static InterpretResult run(VM* vm) {
                         break;
                     }
                 }
-                break;
+                DISPATCH();
             }
-            case OP_SUBSCRIPT_IDX_NOPOP: {
+            TARGET(OP_SUBSCRIPT_IDX_NOPOP): {
                 Value possibleIndex = peek(vm, 0);
                 Value receiver = peek(vm, 1);
                 Value value;
-                
+
+                if (IS_ARRAY(receiver) && IS_NUMBER(possibleIndex)) {
+                    ObjArray* array = AS_ARRAY(receiver);
+                    int index = AS_INTEGER(possibleIndex);
+                    if (!arrayIndex(vm, array, &index)) {
+                        return INTERPRET_RUNTIME_ERROR;
+                    }
+                    push(vm, NUMBER_VAL(array->values[index]));
+                    DISPATCH();
+                }
+                if (IS_MAP(receiver)) {
+                    if (!mapIndex(vm, AS_MAP(receiver), possibleIndex, &value)) {
+                        return INTERPRET_RUNTIME_ERROR;
+                    }
+                    push(vm, value);
+                    DISPATCH();
+                }
                 if (!IS_LIST(receiver)) {
                     runtimeError(vm, "Invalid subscript operation to unsupported type.");
                     return INTERPRET_RUNTIME_ERROR;
@@ -696,7 +1379,7 @@ static InterpretResult run(VM* vm) {
                     runtimeError(vm, "Subscript index must be a number.");
                     return INTERPRET_RUNTIME_ERROR;
                 }
-                int index = AS_NUMBER(possibleIndex);
+                int index = AS_INTEGER(possibleIndex);
                 ObjList* list = AS_LIST(receiver);
                 if (!validIndexList(vm, list, index)) {
                     runtimeError(vm, "List index out of bounds (given %d, length %d)",
@@ -705,19 +1388,57 @@ static InterpretResult run(VM* vm) {
                 }
                 value = getFromIndexList(vm, list, index);
                 push(vm, value);
-                break;
+                DISPATCH();
+            }
+            TARGET(OP_SLICE): {
+                Value end = pop(vm);
+                Value start = pop(vm);
+                Value receiver = peek(vm, 0);
+                if (!IS_OBJ(receiver)) {
+                    runtimeError(vm, "Invalid slice operation to unsupported type.");
+                    return INTERPRET_RUNTIME_ERROR;
+                }
+                int length;
+                switch (OBJ_TYPE(receiver)) {
+                    case OBJ_LIST: length = AS_LIST(receiver)->items.count; break;
+                    case OBJ_ARRAY: length = AS_ARRAY(receiver)->count; break;
+                    case OBJ_STRING: length = AS_STRING(receiver)->length; break;
+                    default:
+                        runtimeError(vm, "Invalid slice operation to unsupported type.");
+                        return INTERPRET_RUNTIME_ERROR;
+                }
+                int from, to;
+                if (!sliceRange(length, start, end, &from, &to)) {
+                    runtimeError(vm, "Slice bounds must be numbers or null.");
+                    return INTERPRET_RUNTIME_ERROR;
+                }
+                Value slice;
+                switch (OBJ_TYPE(receiver)) {
+                    case OBJ_LIST:
+                        slice = OBJ_VAL(sliceList(vm, AS_LIST(receiver), from, to));
+                        break;
+                    case OBJ_ARRAY:
+                        slice = OBJ_VAL(sliceArray(vm, AS_ARRAY(receiver), from, to));
+                        break;
+                    default:
+                        slice = OBJ_VAL(copyString(vm,
+                                    AS_STRING(receiver)->chars + from, to - from));
+                        break;
+                }
+                vm->stackTop[-1] = slice;
+                DISPATCH();
             }
-            case OP_GET_UPVALUE: {
+            TARGET(OP_GET_UPVALUE): {
                 uint8_t slot = READ_BYTE();
                 push(vm, *frame->closure->upvalues[slot]->location);
-                break;
+                DISPATCH();
             }
-            case OP_SET_UPVALUE: {
+            TARGET(OP_SET_UPVALUE): {
                 uint8_t slot = READ_BYTE();
                 *frame->closure->upvalues[slot]->location = peek(vm,0);
-                break;
+                DISPATCH();
             }
-            case OP_GET_PROPERTY: {
+            TARGET(OP_GET_PROPERTY): {
                 Value receiver = peek(vm, 0);
 
                 if (isObjType(receiver, OBJ_INSTANCE)) {
@@ -730,11 +1451,12 @@ static InterpretResult run(VM* vm) {
                     if (tableGet(&instance->fields, name, &value)) {
                         pop(vm);
                         push(vm, value);
-                        break;
+                        DISPATCH();
                     }
                     if(!bindMethod(vm, instance->klass, name)) {
                         return INTERPRET_RUNTIME_ERROR;
                     }
+                    DISPATCH();
                 } else if (isObjType(receiver, OBJ_MODULE)) {
                     ObjModule* module = AS_MODULE(receiver);
                     ObjString* name = READ_STRING();
@@ -742,14 +1464,16 @@ static InterpretResult run(VM* vm) {
                     if (tableGet(&module->values, name, &value)) {
                         pop(vm);
                         push(vm, value);
-                        break;
+                        DISPATCH();
                     }
                     runtimeError(vm, "Module '%s' has no attribute '%s'.",
                             module->name->chars, name->chars);
+                } else {
+                    runtimeError(vm, "Only instances have properties.");
                 }
                 return INTERPRET_RUNTIME_ERROR;
             }
-            case OP_SET_PROPERTY: {
+            TARGET(OP_SET_PROPERTY): {
                 if (!IS_INSTANCE(peek(vm,1))) {
                     runtimeError(vm, "Only instances have fields.");
                     return INTERPRET_RUNTIME_ERROR;
@@ -762,9 +1486,9 @@ static InterpretResult run(VM* vm) {
                 pop(vm);
                 pop(vm);
                 push(vm, NULL_VAL);
-                break;
+                DISPATCH();
             }
-            case OP_GET_PROPERTY_NOPOP: {
+            TARGET(OP_GET_PROPERTY_NOPOP): {
                 
                 if (!IS_INSTANCE(peek(vm,1))) {
                     runtimeError(vm, "Only instances have fields.");
@@ -775,82 +1499,251 @@ static InterpretResult run(VM* vm) {
                 Value value;
                 if (tableGet(&instance->fields, name, &value)) {
                     push(vm, value);
-                    break;
-                }
-                if (bindMethod(vm, instance->klass, name)) {
-                    break;
+                    DISPATCH();
                 }
-
-                break;
+                // the value is always updated in place, so it must be a field
+                runtimeError(vm, "Undefined field '%s'.", name->chars);
+                return INTERPRET_RUNTIME_ERROR;
             }
-            case OP_GET_SUPER: {
+            TARGET(OP_GET_SUPER): {
                 ObjString* name = READ_STRING();
                 ObjClass* superclass = AS_CLASS(pop(vm));
 
                 if (!bindMethod(vm, superclass, name)) {
                     return INTERPRET_RUNTIME_ERROR;
                 }
-                break;
+                DISPATCH();
             }
-            case OP_EQUAL: {
+            TARGET(OP_EQUAL): {
                 Value b = pop(vm);
                 Value a = pop(vm);
                 push(vm, BOOL_VAL( valuesEqual(a, b)) );
-                break;
+                DISPATCH();
             }
 
-            case OP_GREATER:  BINARY_OP(vm, BOOL_VAL, >); break;
-            case OP_LESS:     BINARY_OP(vm, BOOL_VAL, <); break;
+            TARGET(OP_NOT_EQUAL): {
+                Value b = pop(vm);
+                Value a = pop(vm);
+                push(vm, BOOL_VAL( !valuesEqual(a, b)) );
+                DISPATCH();
+            }
 
-            case OP_ADD: {
+            TARGET(OP_GREATER):
+                BINARY_OP(vm, BOOL_VAL, INT_COMPARE, >);
+                DISPATCH();
+            TARGET(OP_LESS):
+                BINARY_OP(vm, BOOL_VAL, INT_COMPARE, <);
+                DISPATCH();
+
+            // fused from OP_LESS, OP_NOT and OP_GREATER, OP_NOT
+            TARGET(OP_GREATER_EQUAL):
+                BINARY_OP(vm, NOT_BOOL_VAL, INT_COMPARE, <);
+                DISPATCH();
+            TARGET(OP_LESS_EQUAL):
+                BINARY_OP(vm, NOT_BOOL_VAL, INT_COMPARE, >);
+                DISPATCH();
+
+            TARGET(OP_ADD): {
+                Value result;
                 if ( IS_STRING(peek(vm,0)) || IS_STRING(peek(vm,1)) ) {
                     concatenate(vm);
-                } else if( IS_NUMBER(peek(vm,0)) && IS_NUMBER(peek(vm,1)) ) {
-                    double b = AS_NUMBER(pop(vm));
-                    double a = AS_NUMBER(pop(vm));
-                    push(vm, NUMBER_VAL(a+b));
+                } else if (NUMBER_OP(result, peek(vm,1), peek(vm,0),
+                                     NUMBER_VAL, INT_ARITH, +)) {
+                    pop(vm);
+                    pop(vm);
+                    push(vm, result);
+                } else if (IS_LIST(peek(vm,0)) && IS_LIST(peek(vm,1))) {
+                    concatenateLists(vm);
                 } else {
                     runtimeError(vm,
-                            "Operands must be two numbers or two strings.");
+                            "Operands must be two numbers, strings or lists.");
                     return INTERPRET_RUNTIME_ERROR;;
                 }
-                break;
-            }
-            case OP_SUBTRACT: BINARY_OP(vm, NUMBER_VAL, -); break;
-            case OP_MULTIPLY: BINARY_OP(vm, NUMBER_VAL, *); break;
-            case OP_DIVIDE:   BINARY_OP(vm, NUMBER_VAL, /); break;
-            case OP_MOD: {
-                if ( (IS_NUMBER(peek(vm,0)) && IS_NUMBER(peek(vm,0))) &&
-                     (AS_NUMBER(peek(vm,0)) == (int)AS_NUMBER(peek(vm,0))) &&
-                     (AS_NUMBER(peek(vm,1)) == (int)AS_NUMBER(peek(vm,1)))
-                   ) {
-                    
-                    int b = (int)AS_NUMBER(pop(vm));
-                    int a = (int)AS_NUMBER(pop(vm));
-                    push(vm, NUMBER_VAL(a%b));
-                } else {
+                DISPATCH();
+            }
+            TARGET(OP_SUBTRACT):
+                BINARY_OP(vm, NUMBER_VAL, INT_ARITH, -);
+                DISPATCH();
+            TARGET(OP_MULTIPLY):
+                BINARY_OP(vm, NUMBER_VAL, INT_PRODUCT, *);
+                DISPATCH();
+            TARGET(OP_DIVIDE):
+                BINARY_OP(vm, NUMBER_VAL, INT_QUOTIENT, /);
+                DISPATCH();
+            TARGET(OP_MOD): {
+                Value b = peek(vm,0);
+                Value a = peek(vm,1);
+                if (!IS_NUMBER(a) || !IS_NUMBER(b) ||
+                    AS_NUMBER(a) != AS_INTEGER(a) ||
+                    AS_NUMBER(b) != AS_INTEGER(b)) {
                     runtimeError(vm, "Operands must be two integers.");
-                    return INTERPRET_RUNTIME_ERROR;;
+                    return INTERPRET_RUNTIME_ERROR;
                 }
-                break;
+                int divisor = AS_INTEGER(b);
+                if (divisor == 0) {
+                    runtimeError(vm, "Modulo by zero.");
+                    return INTERPRET_RUNTIME_ERROR;
+                }
+                pop(vm);
+                pop(vm);
+                // INT_MIN % -1 overflows in C
+                push(vm, INT_VAL(divisor == -1 ? 0 : AS_INTEGER(a) % divisor));
+                DISPATCH();
+            }
+            TARGET(OP_ADD_LL):
+                REGISTER_OP(vm, OP_ADD, NUMBER_VAL, INT_ARITH, +,
+                            READ_LOCAL(), READ_LOCAL(), PUSH_RESULT);
+                DISPATCH();
+            TARGET(OP_SUBTRACT_LL):
+                REGISTER_OP(vm, OP_SUBTRACT, NUMBER_VAL, INT_ARITH, -,
+                            READ_LOCAL(), READ_LOCAL(), PUSH_RESULT);
+                DISPATCH();
+            TARGET(OP_MULTIPLY_LL):
+                REGISTER_OP(vm, OP_MULTIPLY, NUMBER_VAL, INT_PRODUCT, *,
+                            READ_LOCAL(), READ_LOCAL(), PUSH_RESULT);
+                DISPATCH();
+            TARGET(OP_DIVIDE_LL):
+                REGISTER_OP(vm, OP_DIVIDE, NUMBER_VAL, INT_QUOTIENT, /,
+                            READ_LOCAL(), READ_LOCAL(), PUSH_RESULT);
+                DISPATCH();
+            TARGET(OP_LESS_LL):
+                REGISTER_OP(vm, OP_LESS, BOOL_VAL, INT_COMPARE, <,
+                            READ_LOCAL(), READ_LOCAL(), PUSH_RESULT);
+                DISPATCH();
+            TARGET(OP_GREATER_LL):
+                REGISTER_OP(vm, OP_GREATER, BOOL_VAL, INT_COMPARE, >,
+                            READ_LOCAL(), READ_LOCAL(), PUSH_RESULT);
+                DISPATCH();
+
+            TARGET(OP_ADD_LC):
+                REGISTER_OP(vm, OP_ADD, NUMBER_VAL, INT_ARITH, +,
+                            READ_LOCAL(), READ_CONSTANT(), PUSH_RESULT);
+                DISPATCH();
+            TARGET(OP_SUBTRACT_LC):
+                REGISTER_OP(vm, OP_SUBTRACT, NUMBER_VAL, INT_ARITH, -,
+                            READ_LOCAL(), READ_CONSTANT(), PUSH_RESULT);
+                DISPATCH();
+            TARGET(OP_MULTIPLY_LC):
+                REGISTER_OP(vm, OP_MULTIPLY, NUMBER_VAL, INT_PRODUCT, *,
+                            READ_LOCAL(), READ_CONSTANT(), PUSH_RESULT);
+                DISPATCH();
+            TARGET(OP_DIVIDE_LC):
+                REGISTER_OP(vm, OP_DIVIDE, NUMBER_VAL, INT_QUOTIENT, /,
+                            READ_LOCAL(), READ_CONSTANT(), PUSH_RESULT);
+                DISPATCH();
+            TARGET(OP_LESS_LC):
+                REGISTER_OP(vm, OP_LESS, BOOL_VAL, INT_COMPARE, <,
+                            READ_LOCAL(), READ_CONSTANT(), PUSH_RESULT);
+                DISPATCH();
+            TARGET(OP_GREATER_LC):
+                REGISTER_OP(vm, OP_GREATER, BOOL_VAL, INT_COMPARE, >,
+                            READ_LOCAL(), READ_CONSTANT(), PUSH_RESULT);
+                DISPATCH();
+
+            TARGET(OP_ADD_LL_SET): {
+                uint8_t dest = READ_BYTE();
+                REGISTER_OP(vm, OP_ADD, NUMBER_VAL, INT_ARITH, +,
+                            READ_LOCAL(), READ_LOCAL(), STORE_RESULT);
+                DISPATCH();
+            }
+            TARGET(OP_SUBTRACT_LL_SET): {
+                uint8_t dest = READ_BYTE();
+                REGISTER_OP(vm, OP_SUBTRACT, NUMBER_VAL, INT_ARITH, -,
+                            READ_LOCAL(), READ_LOCAL(), STORE_RESULT);
+                DISPATCH();
+            }
+            TARGET(OP_MULTIPLY_LL_SET): {
+                uint8_t dest = READ_BYTE();
+                REGISTER_OP(vm, OP_MULTIPLY, NUMBER_VAL, INT_PRODUCT, *,
+                            READ_LOCAL(), READ_LOCAL(), STORE_RESULT);
+                DISPATCH();
+            }
+            TARGET(OP_DIVIDE_LL_SET): {
+                uint8_t dest = READ_BYTE();
+                REGISTER_OP(vm, OP_DIVIDE, NUMBER_VAL, INT_QUOTIENT, /,
+                            READ_LOCAL(), READ_LOCAL(), STORE_RESULT);
+                DISPATCH();
+            }
+            TARGET(OP_ADD_LC_SET): {
+                uint8_t dest = READ_BYTE();
+                REGISTER_OP(vm, OP_ADD, NUMBER_VAL, INT_ARITH, +,
+                            READ_LOCAL(), READ_CONSTANT(), STORE_RESULT);
+                DISPATCH();
+            }
+            TARGET(OP_SUBTRACT_LC_SET): {
+                uint8_t dest = READ_BYTE();
+                REGISTER_OP(vm, OP_SUBTRACT, NUMBER_VAL, INT_ARITH, -,
+                            READ_LOCAL(), READ_CONSTANT(), STORE_RESULT);
+                DISPATCH();
             }
-            case OP_INCREMENT: {
+            TARGET(OP_MULTIPLY_LC_SET): {
+                uint8_t dest = READ_BYTE();
+                REGISTER_OP(vm, OP_MULTIPLY, NUMBER_VAL, INT_PRODUCT, *,
+                            READ_LOCAL(), READ_CONSTANT(), STORE_RESULT);
+                DISPATCH();
+            }
+            TARGET(OP_DIVIDE_LC_SET): {
+                uint8_t dest = READ_BYTE();
+                REGISTER_OP(vm, OP_DIVIDE, NUMBER_VAL, INT_QUOTIENT, /,
+                            READ_LOCAL(), READ_CONSTANT(), STORE_RESULT);
+                DISPATCH();
+            }
+
+            TARGET(OP_INCREMENT_LOCAL): {
+                Value* slot = &frame->slots[READ_BYTE()];
+                if (!IS_NUMBER(*slot)) {
+                    runtimeError(vm, "Operand must be a number");
+                    return INTERPRET_RUNTIME_ERROR;
+                }
+                *slot = IS_INT(*slot) ? intToValue((int64_t)AS_INT(*slot) + 1)
+                                      : NUMBER_VAL(AS_DOUBLE(*slot) + 1);
+                DISPATCH();
+            }
+            TARGET(OP_DECREMENT_LOCAL): {
+                Value* slot = &frame->slots[READ_BYTE()];
+                if (!IS_NUMBER(*slot)) {
+                    runtimeError(vm, "Operand must be a number");
+                    return INTERPRET_RUNTIME_ERROR;
+                }
+                *slot = IS_INT(*slot) ? intToValue((int64_t)AS_INT(*slot) - 1)
+                                      : NUMBER_VAL(AS_DOUBLE(*slot) - 1);
+                DISPATCH();
+            }
+
+            TARGET(OP_JUMP_IF_NOT_LESS_LL):
+                COMPARE_BRANCH(vm, <, READ_LOCAL(), READ_LOCAL());
+                DISPATCH();
+            TARGET(OP_JUMP_IF_NOT_GREATER_LL):
+                COMPARE_BRANCH(vm, >, READ_LOCAL(), READ_LOCAL());
+                DISPATCH();
+            TARGET(OP_JUMP_IF_NOT_LESS_LC):
+                COMPARE_BRANCH(vm, <, READ_LOCAL(), READ_CONSTANT());
+                DISPATCH();
+            TARGET(OP_JUMP_IF_NOT_GREATER_LC):
+                COMPARE_BRANCH(vm, >, READ_LOCAL(), READ_CONSTANT());
+                DISPATCH();
+
+            TARGET(OP_INCREMENT): {
                 if (!IS_NUMBER(peek(vm,0))) {
                     runtimeError(vm, "Operand must be a number");
                     return INTERPRET_RUNTIME_ERROR;
                 }
-                push(vm,  NUMBER_VAL( AS_NUMBER(pop(vm))+1 ) );
-                break;
+                Value value = pop(vm);
+                push(vm, IS_INT(value) ? intToValue((int64_t)AS_INT(value) + 1)
+                                       : NUMBER_VAL(AS_DOUBLE(value) + 1));
+                DISPATCH();
             }
-            case OP_DECREMENT: {
+            TARGET(OP_DECREMENT): {
                 if (!IS_NUMBER(peek(vm,0))) {
                     runtimeError(vm, "Operand must be a number");
                     return INTERPRET_RUNTIME_ERROR;
                 }
-                push(vm,  NUMBER_VAL( AS_NUMBER(pop(vm))-1 ) );
-                break;
+                Value value = pop(vm);
+                push(vm, IS_INT(value) ? intToValue((int64_t)AS_INT(value) - 1)
+                                       : NUMBER_VAL(AS_DOUBLE(value) - 1));
+                DISPATCH();
             }
-            case OP_MODULE: {
+            TARGET(OP_MODULE): {
                 ObjString* fileName = READ_STRING();
                 Value moduleVal;
 
@@ -869,7 +1762,7 @@ static InterpretResult run(VM* vm) {
                     pop(vm);
                     vm->lastModule = AS_MODULE(moduleVal);
                     push(vm, NULL_VAL);
-                    break;
+                    DISPATCH();
                 }
 
                 char* source = readFile_VM(vm, path);
@@ -899,88 +1792,209 @@ static InterpretResult run(VM* vm) {
                 call(vm, closure, 0);
                 frame = &vm->frames[vm->frameCount - 1];
 //                ip = frame->ip;
-                break;
+                DISPATCH();
             }
-            case OP_MODULE_VAR: {
+            TARGET(OP_MODULE_VAR): {
                 push(vm, OBJ_VAL(vm->lastModule));
-                break;
+                DISPATCH();
             }
-            case OP_MODULE_END: {
+            TARGET(OP_MODULE_END): {
                 vm->lastModule = frame->closure->function->module;
-                break;
+                DISPATCH();
             }
-            case OP_MODULE_BUILTIN: {
+            TARGET(OP_MODULE_BUILTIN): {
                 int index = READ_BYTE();
                 ObjString* name = READ_STRING();
                 Value stdLibVal;
                 if (tableGet(&vm->modules, name, &stdLibVal)) {
                     push(vm, stdLibVal);
-                    break;
+                    DISPATCH();
                 }
                 ObjModule* stdLib = importStdLib(vm, index);
                 push(vm, OBJ_VAL(stdLib));
-                break;
+                DISPATCH();
             }
-            case OP_NOT:
+            TARGET(OP_NOT):
                 push(vm, BOOL_VAL(isFalsey(pop(vm))));
-                break;
+                DISPATCH();
 
-            case OP_NEGATE: {
+            TARGET(OP_NEGATE): {
                 if (!IS_NUMBER(peek(vm,0))) {
                     runtimeError(vm, "Operand must be a number.");
                     return INTERPRET_RUNTIME_ERROR;
                 }
-                push(vm,  NUMBER_VAL( -AS_NUMBER(pop(vm)) ) );
-                break;
+                Value value = pop(vm);
+                push(vm, IS_INT(value) ? intNegation(AS_INT(value))
+                                       : NUMBER_VAL(-AS_DOUBLE(value)));
+                DISPATCH();
             }
-            case OP_PRINT: {
+            TARGET(OP_PRINT): {
                 printValue(stdout, pop(vm));
                 printf("\n");
-                break;
+                DISPATCH();
             }
-            case OP_JUMP: {
+            TARGET(OP_JUMP): {
                 uint16_t offset = READ_SHORT();
                 frame->ip += offset;
-                break;
+                DISPATCH();
             }
-            case OP_JUMP_IF_FALSE: {
+            TARGET(OP_JUMP_IF_FALSE): {
                 uint16_t offset = READ_SHORT();
                 if (isFalsey(peek(vm,0))) frame->ip += offset;
-                break;
+                DISPATCH();
             }
-            case OP_LOOP: {
+            TARGET(OP_LOOP): {
                 uint16_t offset = READ_SHORT();
                 frame->ip -= offset;
-                break;
+                DISPATCH();
+            }
+            TARGET(OP_ITER_INIT): {
+                if (!isIterable(peek(vm, 0))) {
+                    runtimeError(vm, "Can only iterate over lists, strings, "
+                                 "Float64Arrays, maps, sets and ranges.");
+                    return INTERPRET_RUNTIME_ERROR;
+                }
+                // the position in the iterable, kept in the next slot
+                push(vm, INT_VAL(0));
+                DISPATCH();
+            }
+            TARGET(OP_ITER_NEXT): {
+                uint8_t slot = READ_BYTE();
+                uint16_t offset = READ_SHORT();
+                Value* state = &frame->slots[slot];
+                Value iterable = state[0];
+                int index = AS_INTEGER(state[1]);
+
+                // lengths are checked on every step, since the loop body
+                // may change the iterable
+                switch (OBJ_TYPE(iterable)) {
+                    case OBJ_LIST: {
+                        ObjList* list = AS_LIST(iterable);
+                        if (index >= list->items.count) break;
+                        state[1] = INT_VAL(index + 1);
+                        push(vm, list->items.values[index]);
+                        DISPATCH();
+                    }
+                    case OBJ_RANGE: {
+                        ObjRange* range = AS_RANGE(iterable);
+                        if (index >= range->count) break;
+                        state[1] = INT_VAL(index + 1);
+                        push(vm, rangeValue(range, index));
+                        DISPATCH();
+                    }
+                    case OBJ_ARRAY: {
+                        ObjArray* array = AS_ARRAY(iterable);
+                        if (index >= array->count) break;
+                        state[1] = INT_VAL(index + 1);
+                        push(vm, NUMBER_VAL(array->values[index]));
+                        DISPATCH();
+                    }
+                    case OBJ_STRING: {
+                        ObjString* string = AS_STRING(iterable);
+                        if (index >= string->length) break;
+                        state[1] = INT_VAL(index + 1);
+                        push(vm, OBJ_VAL(copyString(vm, &string->chars[index], 1)));
+                        DISPATCH();
+                    }
+                    case OBJ_MAP:
+                    case OBJ_SET: {
+                        // maps give their keys, stepping over empty slots
+                        ValueTable* table = IS_MAP(iterable) ?
+                                            &AS_MAP(iterable)->table :
+                                            &AS_SET(iterable)->table;
+                        while (index < table->capacity &&
+                               IS_NULL(table->entries[index].key)) index++;
+                        if (index >= table->capacity) break;
+                        state[1] = INT_VAL(index + 1);
+                        push(vm, table->entries[index].key);
+                        DISPATCH();
+                    }
+                    default:
+                        break;
+                }
+                frame->ip += offset;
+                DISPATCH();
+            }
+            TARGET(OP_CALL): {
+                int argCount = READ_BYTE();
+                Value callee = peek(vm, argCount);
+                if (IS_NATIVE(callee)) {
+                    // the call site is rewritten to go straight to natives
+                    frame->ip[-2] = OP_CALL_NATIVE;
+                    if (!callNative(vm, AS_NATIVE(callee), argCount,
+                                    vm->stackTop - argCount)) {
+                        return INTERPRET_RUNTIME_ERROR;
+                    }
+                    // natives calling back into the VM may move the frames
+                    frame = &vm->frames[vm->frameCount-1];
+                    DISPATCH();
+                }
+                if (!callValue(vm, callee, argCount)) {
+                    return INTERPRET_RUNTIME_ERROR;
+                }
+                frame = &vm->frames[vm->frameCount-1];
+                DISPATCH();
             }
-            case OP_CALL: {
+            TARGET(OP_CALL_NATIVE): {
                 int argCount = READ_BYTE();
-                if (!callValue(vm, peek(vm,argCount), argCount)) {
+                Value callee = peek(vm, argCount);
+                if (IS_NATIVE(callee)) {
+                    // the site can later call a native of another arity, so
+                    // callNative still checks the argument count each time
+                    if (!callNative(vm, AS_NATIVE(callee), argCount,
+                                    vm->stackTop - argCount)) {
+                        return INTERPRET_RUNTIME_ERROR;
+                    }
+                    frame = &vm->frames[vm->frameCount-1];
+                    DISPATCH();
+                }
+                if (!callValue(vm, callee, argCount)) {
                     return INTERPRET_RUNTIME_ERROR;
                 }
                 frame = &vm->frames[vm->frameCount-1];
-                break;
+                DISPATCH();
             }
-            case OP_INVOKE: {
+            TARGET(OP_INVOKE): {
                 ObjString* method = READ_STRING();
                 int argCount = READ_BYTE();
-                if(!invoke(vm, method, argCount)) {
+                InvokeCache* cache = READ_CACHE();
+                if(!invoke(vm, method, argCount, cache, false)) {
                     return INTERPRET_RUNTIME_ERROR;
                 }
                 frame = &vm->frames[vm->frameCount-1];
-                break;
+                DISPATCH();
             }
-            case OP_SUPER_INVOKE: {
+            TARGET(OP_TAIL_CALL): {
+                int argCount = READ_BYTE();
+                if (!tailCallValue(vm, peek(vm,argCount), argCount)) {
+                    return INTERPRET_RUNTIME_ERROR;
+                }
+                frame = &vm->frames[vm->frameCount-1];
+                DISPATCH();
+            }
+            TARGET(OP_TAIL_INVOKE): {
                 ObjString* method = READ_STRING();
                 int argCount = READ_BYTE();
+                InvokeCache* cache = READ_CACHE();
+                if (!invoke(vm, method, argCount, cache, true)) {
+                    return INTERPRET_RUNTIME_ERROR;
+                }
+                frame = &vm->frames[vm->frameCount-1];
+                DISPATCH();
+            }
+            TARGET(OP_SUPER_INVOKE): {
+                ObjString* method = READ_STRING();
+                int argCount = READ_BYTE();
+                InvokeCache* cache = READ_CACHE();
                 ObjClass* superclass = AS_CLASS(pop(vm));
-                if (!invokeFromClass(vm, superclass, method, argCount)) {
+                if (!invokeFromClass(vm, superclass, method, argCount, cache,
+                                     false)) {
                     return INTERPRET_RUNTIME_ERROR;
                 }
                 frame = &vm->frames[vm->frameCount-1];
-                break;
+                DISPATCH();
             }
-            case OP_CLOSURE: {
+            TARGET(OP_CLOSURE): {
                 ObjFunction* function = AS_FUNCTION(READ_CONSTANT());
                 ObjClosure* closure = newClosure(vm, function);
                 push(vm, OBJ_VAL(closure));
@@ -994,30 +2008,27 @@ static InterpretResult run(VM* vm) {
                         closure->upvalues[i] = frame->closure->upvalues[index];
                     }
                 }
-                break;
+                DISPATCH();
             }
-            case OP_CLOSE_UPVALUE:
+            TARGET(OP_CLOSE_UPVALUE):
                 closeUpvalues(vm, vm->stackTop - 1);
                 pop(vm);
-                break;
-            case OP_RETURN: {
+                DISPATCH();
+            TARGET(OP_RETURN): {
                 // holding onto the return value of the function
                 Value result = pop(vm);
                 closeUpvalues(vm, frame->slots);
                 vm->frameCount--;
-                if (vm->frameCount == 0) {
-                    pop(vm);
-                    return INTERPRET_OK;
-                }
                 vm->stackTop = frame->slots;
                 push(vm, result); // pushing the return value back onto the stack
+                if (vm->frameCount == baseFrame) return INTERPRET_OK;
                 frame = &vm->frames[vm->frameCount-1];
-                break;
+                DISPATCH();
             }
-            case OP_CLASS:
+            TARGET(OP_CLASS):
                 push(vm,  OBJ_VAL(newClass(vm, READ_STRING())) );
-                break;
-            case OP_INHERIT: {
+                DISPATCH();
+            TARGET(OP_INHERIT): {
                 Value superclass = peek(vm,1); // superclass def top
                                             //[<subclass>, <superclass>]
                 if (!IS_CLASS(superclass)) {
@@ -1028,18 +2039,28 @@ static InterpretResult run(VM* vm) {
                 tableAddAll(vm, &AS_CLASS(superclass)->methods,
                             &subclass->methods);
                 pop(vm);
-                break;
+                DISPATCH();
             }
-            case OP_METHOD:
+            TARGET(OP_METHOD):
                 defineMethod(vm, READ_STRING());
-                break;
+                DISPATCH();
         }
     }
 #undef READ_BYTE
 #undef READ_CONSTANT
 #undef READ_STRING
+#undef READ_CACHE
 #undef READ_SHORT
+#undef READ_LOCAL
 #undef BINARY_OP
+#undef NOT_BOOL_VAL
+#undef REGISTER_OP
+#undef PUSH_RESULT
+#undef STORE_RESULT
+#undef COMPARE_BRANCH
+#undef BEFORE_INSTRUCTION
+#undef TARGET
+#undef DISPATCH
 }
 
 InterpretResult interpret(VM* vm, char* moduleName, const char* source) {
@@ -1061,6 +2082,28 @@ InterpretResult interpret(VM* vm, char* moduleName, const char* source) {
     push(vm, OBJ_VAL(closure));
     call(vm, closure, 0);
 
-    InterpretResult result = run(vm);
+    InterpretResult result = run(vm, 0);
+    if (result == INTERPRET_OK) pop(vm); // the script's return value
     return result;
 }
+
+bool vmCall(VM* vm, Value callee, int argCount, Value* args, Value* result) {
+    // arguments on the VM stack have to follow it if it is moved
+    uintptr_t oldStack = (uintptr_t)vm->stack;
+    uintptr_t at = (uintptr_t)args;
+    bool onStack = at >= oldStack && at < (uintptr_t)vm->stackTop;
+    if (!ensureStack(vm, argCount + 1 + FRAME_SLACK)) {
+        runtimeError(vm, "Stack overflow.");
+        return false;
+    }
+    if (onStack) args = vm->stack + (at - oldStack) / sizeof(Value);
+    int baseFrame = vm->frameCount;
+    push(vm, callee);
+    for (int i = 0; i < argCount; i++) push(vm, args[i]);
+    if (!callValue(vm, callee, argCount)) return false;
+    // natives and classes without initializers return without a new frame
+    if (vm->frameCount > baseFrame &&
+        run(vm, baseFrame) != INTERPRET_OK) return false;
+    *result = pop(vm);
+    return true;
+}
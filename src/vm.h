@@ -6,9 +6,16 @@
 #include "object.h"
 #include "table.h"
 
-#define FRAMES_MAX 64
+// deepest call nesting, can be overridden at build time
+#ifndef FRAMES_MAX
+#define FRAMES_MAX 8192
+#endif
 #define STACK_MAX (FRAMES_MAX * UINT8_COUNT)
 
+#define FRAMES_MIN 16                 // call frames allocated up front
+#define STACK_MIN  (4 * UINT8_COUNT)  // stack values allocated up front
+#define FRAME_SLACK 16                // stack room kept above each frame
+
 /**
  * @brief Struct to define the callframe of a function
  *
@@ -25,19 +32,27 @@ typedef struct {
  */
 struct _vm {
     Compiler* compiler;
-    CallFrame frames[FRAMES_MAX]; // each callframe has its own ip and
-                                  // pointer to ObjFunction
+    CallFrame* frames; // each callframe has its own ip and
+                       // pointer to ObjFunction
     bool repl;
+    bool registerOps; // if the optimizer emits register-style ops
     int frameCount; // current height of the frames stack
+    int frameCapacity;
 
-    Value stack[STACK_MAX];
+    Value* stack;     // grows on calls, so pointers into it move
     Value* stackTop;
+    int stackCapacity;
     ObjString* initString;
-    ObjUpvalue* openUpvalues; // upvalue array
+    ObjUpvalue** openUpvalues; // open upvalue of each stack slot, or NULL
+    int openTop;               // no upvalues are open from this slot up
 
     Table globals;            // hash table to hold global variables
     Table strings;            // every string that's created
     Table listMethods;        // list methods
+    Table arrayMethods;       // Float64Array methods
+    Table mapMethods;         // map methods
+    Table setMethods;         // set methods
+    Table rangeMethods;       // range methods
     Table stringMethods;      // string methods
 
     ObjModule* lastModule;    // modules
@@ -49,6 +64,10 @@ struct _vm {
     int grayCount;
     int grayCapacity;
     Obj** grayStack;
+
+#ifdef DEBUG_COUNT_INSTRUCTIONS
+    unsigned long long instructionCount; // instructions dispatched so far
+#endif
 };
 
 // Runtime error function declaration
@@ -71,4 +90,21 @@ void push(VM* vm, Value value);
  */
 Value pop(VM* vm);
 
+/**
+ * @brief Calling a value from native code. The VM runs until the call
+ * returns, so natives can call back into script functions. The arguments
+ * are kept on the stack during the call, but the result is not rooted, so
+ * it has to be pushed before anything else is allocated. The stack may be
+ * moved by the call, so a native's `args` pointer must not be used after
+ * it. On failure the error has been reported and the stack reset, and the
+ * native should return BAD_VAL.
+ *
+ * @param callee Value to call
+ * @param argCount The number of arguments
+ * @param args The arguments, either on the stack or anywhere else
+ * @param result Set to the value the call returns
+ * @return bool False if the call raised a runtime error
+ */
+bool vmCall(VM* vm, Value callee, int argCount, Value* args, Value* result);
+
 #endif